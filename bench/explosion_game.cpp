@@ -0,0 +1,26 @@
+#include "explosion_game.h"
+
+using namespace std;
+
+ExplosionGame::ExplosionGame(board_coord_t size, uint16_t radius) : GameInfo() {
+    basic_info.size_x_ = size;
+    basic_info.size_y_ = size;
+    explosion_radius = radius;
+    blocks.reset(size, size);
+}
+
+void ExplosionGame::place_block(const Position &position) {
+    blocks.insert(position);
+}
+
+void ExplosionGame::place_player(player_id_t id, const Position &position) {
+    set_player_position(players.emplace(id, PlayerInfo{id, {}, position, 0}).first->second, position);
+}
+
+void ExplosionGame::explode_virtual(vector<Position> &bombs) {
+    for (auto &bomb: bombs) {
+        make_bomb_explosion(bomb, [this](Position &position, bool is_block) {
+            handle_explosion_for_position(position, is_block);
+        });
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef ROBOTS_EXPLOSION_GAME_H
+#define ROBOTS_EXPLOSION_GAME_H
+
+#include "../structures.h"
+#include "../game_managers/game_info.h"
+#include <vector>
+
+// Board, on which bombs explode without turns and events. Cells reached by
+// explosions are given to a template parameter, like in game info now, or
+// to a virtual function, like before the handler became a template.
+class ExplosionGame : public GameInfo {
+public:
+    ExplosionGame(board_coord_t size, uint16_t radius);
+
+    virtual ~ExplosionGame() = default;
+
+    void place_block(const Position &position);
+    void place_player(player_id_t id, const Position &position);
+
+    template<typename CellHandler>
+    void explode_static(std::vector<Position> &bombs, CellHandler handle_cell) const {
+        for (auto &bomb: bombs) {
+            make_bomb_explosion(bomb, handle_cell);
+        }
+    }
+
+    // Defined in other file than overrides of handle_explosion_for_position,
+    // so calls aren't inlined, like calls from game_info.cpp were
+    void explode_virtual(std::vector<Position> &bombs);
+
+protected:
+    virtual void handle_explosion_for_position(Position &position, bool is_block) = 0;
+};
+
+#endif //ROBOTS_EXPLOSION_GAME_H
@@ -0,0 +1,503 @@
+// Microbenchmarks of hot paths of client and server, each one compared with
+// the way it was done before. Results are nanoseconds per operation, the
+// checksum is printed only so the compiler can't skip the measured work.
+// Not built by default: cmake --build <dir> --target robots-bench
+
+#include "../structures.h"
+#include "../buffers/codec.h"
+#include "../buffers/outgoing_buffer.h"
+#include "../buffers/tcp_incoming_buffer.h"
+#include "../game_managers/block_grid.h"
+#include "explosion_game.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    uint64_t checksum = 0;
+
+    // the best of a few runs is printed, so other processes disturb results less
+    constexpr size_t RUNS_NO = 5;
+
+    template<typename F>
+    void measure(const string &name, size_t operations, F f) {
+        // one run before measuring, so memory is already allocated
+        f();
+
+        double best_time = numeric_limits<double>::max();
+        for (size_t run = 0; run < RUNS_NO; run++) {
+            auto start = chrono::steady_clock::now();
+            f();
+            best_time = min(best_time, chrono::duration<double, nano>(chrono::steady_clock::now() - start).count());
+        }
+
+        cout << "  " << name << ": " << best_time / static_cast<double>(operations) << " ns/op\n";
+    }
+
+    vector<uint8_t> encode_all(const vector<ClientMessage::client_message> &msgs) {
+        vector<uint8_t> result;
+        for (auto &msg: msgs) {
+            OutgoingBuffer encoded(msg);
+            result.insert(result.end(), encoded.get_buffer(), encoded.get_buffer() + encoded.size());
+        }
+        return result;
+    }
+
+    vector<uint8_t> encode_all(const vector<ServerMessage::server_message> &msgs) {
+        vector<uint8_t> result;
+        for (auto &msg: msgs) {
+            OutgoingBuffer encoded(msg);
+            result.insert(result.end(), encoded.get_buffer(), encoded.get_buffer() + encoded.size());
+        }
+        return result;
+    }
+
+    // Reading until decoding throws length_error, like before try_read API
+    template<typename T>
+    void read_with_exceptions(const vector<uint8_t> &stream, size_t packet_size) {
+        vector<uint8_t> buffer;
+        size_t read_index = 0;
+        T msg;
+
+        for (size_t offset = 0; offset < stream.size(); offset += packet_size) {
+            size_t size = min(packet_size, stream.size() - offset);
+            buffer.insert(buffer.end(), stream.begin() + static_cast<ptrdiff_t>(offset),
+                          stream.begin() + static_cast<ptrdiff_t>(offset + size));
+
+            for (;;) {
+                try {
+                    Codec::Reader reader(buffer.data() + read_index, buffer.size() - read_index);
+                    Codec::decode(reader, msg);
+                    read_index += reader.get_index();
+                    checksum += msg.index();
+                } catch (length_error &e) {
+                    break;
+                }
+            }
+
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(read_index));
+            read_index = 0;
+        }
+    }
+
+    template<typename T, typename Read>
+    void read_with_status(const vector<uint8_t> &stream, size_t packet_size, Read read) {
+        TcpIncomingBuffer buffer;
+        vector<uint8_t> packet(packet_size);
+        T msg;
+
+        for (size_t offset = 0; offset < stream.size(); offset += packet_size) {
+            size_t size = min(packet_size, stream.size() - offset);
+            copy(stream.begin() + static_cast<ptrdiff_t>(offset),
+                 stream.begin() + static_cast<ptrdiff_t>(offset + size), packet.begin());
+            buffer.add_packet(packet, size);
+
+            while (read(buffer, msg) == ReadStatus::COMPLETE) {
+                checksum += msg.index();
+            }
+        }
+    }
+
+    void bench_message_reading() {
+        constexpr size_t MESSAGES_NO = 100000;
+        minstd_rand random_engine(1);
+
+        vector<ClientMessage::client_message> client_msgs;
+        for (size_t i = 0; i < MESSAGES_NO; i++) {
+            client_msgs.emplace_back(ClientMessage::Move{static_cast<Direction>(random_engine() % 4)});
+        }
+
+        vector<ServerMessage::server_message> server_msgs;
+        for (size_t i = 0; i < MESSAGES_NO; i++) {
+            ServerMessage::Turn turn{static_cast<uint16_t>(i), {}};
+            for (uint8_t id = 0; id < 4; id++) {
+                turn.events.emplace_back(Event::PlayerMovedEvent{id, Position{id, static_cast<uint16_t>(i)}});
+            }
+            turn.events.emplace_back(Event::BombExplodedEvent{static_cast<bomb_id_t>(i), {1, 2},
+                                                              {Position{1, 2}, Position{3, 4}}});
+            server_msgs.emplace_back(move(turn));
+        }
+
+        vector<uint8_t> client_stream = encode_all(client_msgs);
+        vector<uint8_t> server_stream = encode_all(server_msgs);
+
+        // at 10k messages/s reads mostly have one message or its part
+        for (size_t packet_size: {client_stream.size() / MESSAGES_NO, size_t{3}, size_t{1400}}) {
+            cout << "client messages (Move) in " << packet_size << " byte reads:\n";
+            measure("length_error at end of buffer", MESSAGES_NO, [&client_stream, packet_size]() {
+                read_with_exceptions<ClientMessage::client_message>(client_stream, packet_size);
+            });
+            measure("try_read_client_message", MESSAGES_NO, [&client_stream, packet_size]() {
+                read_with_status<ClientMessage::client_message>(
+                        client_stream, packet_size, [](TcpIncomingBuffer &buffer, ClientMessage::client_message &msg) {
+                            return buffer.try_read_client_message(msg);
+                        });
+            });
+        }
+
+        for (size_t packet_size: {server_stream.size() / MESSAGES_NO, size_t{16}, size_t{1400}}) {
+            cout << "server messages (Turn with 5 events) in " << packet_size << " byte reads:\n";
+            measure("length_error at end of buffer", MESSAGES_NO, [&server_stream, packet_size]() {
+                read_with_exceptions<ServerMessage::server_message>(server_stream, packet_size);
+            });
+            measure("try_read_server_message", MESSAGES_NO, [&server_stream, packet_size]() {
+                read_with_status<ServerMessage::server_message>(
+                        server_stream, packet_size, [](TcpIncomingBuffer &buffer, ServerMessage::server_message &msg) {
+                            return buffer.try_read_server_message(msg);
+                        });
+            });
+        }
+    }
+
+    // Position by position with a size check for each one, like before bulk conversion
+    void encode_positions_element_wise(Codec::Writer &writer, const vector<Position> &positions) {
+        writer.write_integer(static_cast<uint32_t>(positions.size()));
+        for (auto &position: positions) {
+            writer.write_integer(position.x);
+            writer.write_integer(position.y);
+        }
+    }
+
+    void decode_positions_element_wise(Codec::Reader &reader, vector<Position> &positions) {
+        reader.check_size(sizeof(uint32_t));
+        auto count = reader.read_integer<uint32_t>();
+
+        positions.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            reader.check_size(Codec::fixed_size<Position>());
+            auto x = reader.read_integer<board_coord_t>();
+            auto y = reader.read_integer<board_coord_t>();
+            positions.emplace_back(Position{x, y});
+        }
+    }
+
+    void bench_positions_conversion() {
+        constexpr size_t REPETITIONS = 1000;
+        minstd_rand random_engine(1);
+
+        for (size_t positions_no: {size_t{16}, size_t{1000}, size_t{100000}}) {
+            vector<Position> positions;
+            for (size_t i = 0; i < positions_no; i++) {
+                positions.emplace_back(Position{static_cast<board_coord_t>(random_engine()),
+                                                static_cast<board_coord_t>(random_engine())});
+            }
+            vector<uint8_t> bytes(Codec::encoded_size(positions));
+            vector<Position> decoded;
+            size_t operations = REPETITIONS * positions_no;
+
+            cout << "vector of " << positions_no << " positions:\n";
+            measure("encode element-wise", operations, [&]() {
+                for (size_t i = 0; i < REPETITIONS; i++) {
+                    Codec::Writer writer(bytes.data());
+                    encode_positions_element_wise(writer, positions);
+                    checksum += bytes[i % bytes.size()];
+                }
+            });
+            measure("encode in bulk", operations, [&]() {
+                for (size_t i = 0; i < REPETITIONS; i++) {
+                    Codec::Writer writer(bytes.data());
+                    Codec::encode(writer, positions);
+                    checksum += bytes[i % bytes.size()];
+                }
+            });
+            measure("decode element-wise", operations, [&]() {
+                for (size_t i = 0; i < REPETITIONS; i++) {
+                    Codec::Reader reader(bytes.data(), bytes.size());
+                    decode_positions_element_wise(reader, decoded);
+                    checksum += decoded.back().x;
+                }
+            });
+            measure("decode in bulk", operations, [&]() {
+                for (size_t i = 0; i < REPETITIONS; i++) {
+                    Codec::Reader reader(bytes.data(), bytes.size());
+                    Codec::decode(reader, decoded);
+                    checksum += decoded.back().x;
+                }
+            });
+        }
+    }
+
+    void bench_blocks() {
+        constexpr board_coord_t SIZE = 1000;
+        constexpr size_t BLOCKS_NO = 100000;
+        constexpr size_t PROBES_NO = 1000000;
+        minstd_rand random_engine(1);
+
+        auto random_position = [&random_engine]() {
+            return Position{static_cast<board_coord_t>(random_engine() % SIZE),
+                            static_cast<board_coord_t>(random_engine() % SIZE)};
+        };
+
+        vector<Position> blocks_positions;
+        for (size_t i = 0; i < BLOCKS_NO; i++) {
+            blocks_positions.emplace_back(random_position());
+        }
+        vector<Position> probes;
+        for (size_t i = 0; i < PROBES_NO; i++) {
+            probes.emplace_back(random_position());
+        }
+
+        unordered_set<Position, Position::Hash> set;
+        BlockGrid grid(SIZE, SIZE);
+
+        cout << "blocks on " << SIZE << "x" << SIZE << " board:\n";
+        measure("insert 100k to unordered_set", BLOCKS_NO, [&]() {
+            set.clear();
+            for (auto &position: blocks_positions) {
+                checksum += set.insert(position).second;
+            }
+        });
+        measure("insert 100k to BlockGrid", BLOCKS_NO, [&]() {
+            grid.clear();
+            for (auto &position: blocks_positions) {
+                checksum += grid.insert(position);
+            }
+        });
+        measure("contains in unordered_set", PROBES_NO, [&]() {
+            for (auto &position: probes) {
+                checksum += set.contains(position);
+            }
+        });
+        measure("contains in BlockGrid", PROBES_NO, [&]() {
+            for (auto &position: probes) {
+                checksum += grid.contains(position);
+            }
+        });
+        measure("iterate unordered_set", set.size(), [&]() {
+            for (auto &position: set) {
+                checksum += position.x;
+            }
+        });
+        measure("iterate BlockGrid", grid.size(), [&]() {
+            grid.for_each([](const Position &position) {
+                checksum += position.x;
+            });
+        });
+        measure("insert and erase in unordered_set", BLOCKS_NO, [&]() {
+            for (auto &position: blocks_positions) {
+                set.insert(position);
+            }
+            for (auto &position: blocks_positions) {
+                checksum += set.erase(position);
+            }
+        });
+        measure("insert and erase in BlockGrid", BLOCKS_NO, [&]() {
+            for (auto &position: blocks_positions) {
+                grid.insert(position);
+            }
+            for (auto &position: blocks_positions) {
+                grid.erase(position);
+            }
+            checksum += grid.size();
+        });
+    }
+
+    constexpr uint8_t DIRECTIONS_NO = 4;
+
+    Position get_moved_position(const Position &position, uint8_t direction, uint32_t distance) {
+        auto x = static_cast<int64_t>(position.x);
+        auto y = static_cast<int64_t>(position.y);
+
+        switch (direction) {
+            case Direction::UP :
+                y += distance;
+                break;
+            case Direction::RIGHT :
+                x += distance;
+                break;
+            case Direction::DOWN :
+                y -= distance;
+                break;
+            default:
+                x -= distance;
+        }
+
+        return {static_cast<board_coord_t>(x), static_cast<board_coord_t>(y)};
+    }
+
+    uint32_t get_distance_to_edge(const Position &position, uint8_t direction, board_coord_t size) {
+        switch (direction) {
+            case Direction::UP :
+                return static_cast<uint32_t>(size - 1 - position.y);
+            case Direction::RIGHT :
+                return static_cast<uint32_t>(size - 1 - position.x);
+            case Direction::DOWN :
+                return position.y;
+            default:
+                return position.x;
+        }
+    }
+
+    // Cells reached in every direction found cell by cell for the whole radius,
+    // like make_bomb_explosion before bit scans
+    uint32_t get_rays_cell_by_cell(const BlockGrid &grid, const Position &bomb, uint16_t radius, board_coord_t size) {
+        bool is_direction_ok[DIRECTIONS_NO] = {true, true, true, true};
+        uint32_t result = 0;
+
+        for (uint32_t distance = 1; distance <= radius; distance++) {
+            for (uint8_t i = 0; i < DIRECTIONS_NO; i++) {
+                if (!is_direction_ok[i] || distance > get_distance_to_edge(bomb, i, size)) {
+                    is_direction_ok[i] = false;
+                    continue;
+                }
+
+                result++;
+                if (grid.contains(get_moved_position(bomb, i, distance))) {
+                    is_direction_ok[i] = false;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    uint32_t get_rays_with_bit_scans(const BlockGrid &grid, const Position &bomb, uint16_t radius, board_coord_t size) {
+        uint32_t result = 0;
+
+        for (uint8_t i = 0; i < DIRECTIONS_NO; i++) {
+            uint32_t max_distance = min<uint32_t>(radius, get_distance_to_edge(bomb, i, size));
+            result += min(max_distance, grid.get_distance_to_block(bomb, static_cast<Direction>(i), max_distance));
+        }
+
+        return result;
+    }
+
+    void bench_explosion_rays() {
+        constexpr size_t BOMBS_NO = 1000;
+        // one block for every BLOCKS_SPACING cells
+        constexpr uint32_t BLOCKS_SPACING = 1000;
+
+        for (board_coord_t size: {board_coord_t{100}, board_coord_t{1000}, board_coord_t{4000}}) {
+            minstd_rand random_engine(1);
+            auto random_position = [&random_engine, size]() {
+                return Position{static_cast<board_coord_t>(random_engine() % size),
+                                static_cast<board_coord_t>(random_engine() % size)};
+            };
+
+            BlockGrid grid(size, size);
+            for (size_t i = 0; i < static_cast<size_t>(size) * size / BLOCKS_SPACING; i++) {
+                grid.insert(random_position());
+            }
+            vector<Position> bombs;
+            while (bombs.size() < BOMBS_NO) {
+                Position bomb = random_position();
+                if (!grid.contains(bomb)) {
+                    bombs.emplace_back(bomb);
+                }
+            }
+
+            for (uint16_t radius: {uint16_t{10}, uint16_t{100}, uint16_t{1000}, uint16_t{UINT16_MAX}}) {
+                cout << "explosion rays on " << size << "x" << size << " board with radius " << radius << ":\n";
+                measure("cell by cell", BOMBS_NO, [&]() {
+                    for (auto &bomb: bombs) {
+                        checksum += get_rays_cell_by_cell(grid, bomb, radius, size);
+                    }
+                });
+                measure("bit scans", BOMBS_NO, [&]() {
+                    for (auto &bomb: bombs) {
+                        checksum += get_rays_with_bit_scans(grid, bomb, radius, size);
+                    }
+                });
+            }
+        }
+    }
+
+    // Collects the same results as server does for every cell of explosion
+    struct ExplosionResults {
+        vector<Position> cells;
+        vector<Position> blocks;
+        vector<player_id_t> robots;
+
+        void handle_cell(const PlayerOccupancy &players_on_positions, Position &position, bool is_block) {
+            cells.emplace_back(position);
+            if (is_block) {
+                blocks.emplace_back(position);
+            }
+            players_on_positions.for_each_player_on(position, [this](player_id_t id) {
+                robots.emplace_back(id);
+            });
+        }
+
+        void clear() {
+            cells.clear();
+            blocks.clear();
+            robots.clear();
+        }
+    };
+
+    class BenchExplosionGame : public ExplosionGame {
+    public:
+        ExplosionResults results;
+
+        BenchExplosionGame(board_coord_t size, uint16_t radius) : ExplosionGame(size, radius), results() {}
+
+        void explode_with_template(vector<Position> &bombs) {
+            explode_static(bombs, [this](Position &position, bool is_block) {
+                results.handle_cell(players_on_positions, position, is_block);
+            });
+        }
+
+    protected:
+        void handle_explosion_for_position(Position &position, bool is_block) override {
+            results.handle_cell(players_on_positions, position, is_block);
+        }
+    };
+
+    void bench_explosion_handler() {
+        constexpr board_coord_t SIZE = 1000;
+        constexpr size_t BOMBS_NO = 1000;
+        constexpr size_t BLOCKS_NO = 1000;
+        constexpr player_id_t PLAYERS_NO = 25;
+
+        for (uint16_t radius: {uint16_t{10}, uint16_t{100}, uint16_t{1000}}) {
+            minstd_rand random_engine(1);
+            auto random_position = [&random_engine]() {
+                return Position{static_cast<board_coord_t>(random_engine() % SIZE),
+                                static_cast<board_coord_t>(random_engine() % SIZE)};
+            };
+
+            BenchExplosionGame game(SIZE, radius);
+            for (size_t i = 0; i < BLOCKS_NO; i++) {
+                game.place_block(random_position());
+            }
+            for (player_id_t id = 0; id < PLAYERS_NO; id++) {
+                game.place_player(id, random_position());
+            }
+            vector<Position> bombs;
+            for (size_t i = 0; i < BOMBS_NO; i++) {
+                bombs.emplace_back(random_position());
+            }
+
+            cout << "turn with " << BOMBS_NO << " explosions of radius " << radius << " on " << SIZE << "x"
+                 << SIZE << " board:\n";
+            measure("virtual handler", BOMBS_NO, [&]() {
+                game.results.clear();
+                game.explode_virtual(bombs);
+                checksum += game.results.cells.size() + game.results.blocks.size() + game.results.robots.size();
+            });
+            measure("template handler", BOMBS_NO, [&]() {
+                game.results.clear();
+                game.explode_with_template(bombs);
+                checksum += game.results.cells.size() + game.results.blocks.size() + game.results.robots.size();
+            });
+        }
+    }
+}
+
+int main() {
+    bench_message_reading();
+    bench_positions_conversion();
+    bench_blocks();
+    bench_explosion_rays();
+    bench_explosion_handler();
+
+    cout << "checksum: " << checksum << "\n";
+    return 0;
+}
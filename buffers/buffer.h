@@ -2,10 +2,19 @@
 #define ROBOTS_BUFFER_H
 
 #include "../structures.h"
+#include "buffer_pool.h"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
-// Superclass for all buffers-parsers
+// Result of trying to read one message from buffer
+enum class ReadStatus : uint8_t {
+    COMPLETE,
+    NEED_MORE,
+    MALFORMED,
+};
+
+// Superclass for all buffers-parsers, memory comes from BufferPool
 class Buffer {
 public:
     using buffer_size_t = size_t;
@@ -23,13 +32,50 @@ protected:
     buffer_size_t capacity_;
     buffer_size_t size_;
 
-    explicit Buffer(buffer_size_t capacity) : buffer_(capacity), capacity_(capacity), size_(0) {}
+    explicit Buffer(buffer_size_t capacity) : buffer_(BufferPool::acquire(capacity)),
+                                              capacity_(buffer_.size()),
+                                              size_(0) {}
+
+    Buffer(const Buffer &other) : buffer_(BufferPool::acquire(other.size_)),
+                                  capacity_(buffer_.size()),
+                                  size_(other.size_) {
+        std::copy(other.buffer_.begin(), other.buffer_.begin() + static_cast<ptrdiff_t>(size_), buffer_.begin());
+    }
+
+    Buffer(Buffer &&other) noexcept: buffer_(std::move(other.buffer_)),
+                                     capacity_(other.capacity_),
+                                     size_(other.size_) {
+        other.capacity_ = 0;
+        other.size_ = 0;
+    }
+
+    Buffer &operator=(const Buffer &other) = delete;
+    Buffer &operator=(Buffer &&other) = delete;
+
+    ~Buffer() {
+        BufferPool::release(std::move(buffer_));
+    }
+
+    // grows geometrically, old content is kept
     void resize_if_needed(buffer_size_t needed_size) {
         if (needed_size > capacity_) {
-            capacity_ = needed_size;
-            buffer_.resize(capacity_, 0);
+            auto new_buffer = BufferPool::acquire(std::max(needed_size, 2 * capacity_));
+            std::copy(buffer_.begin(), buffer_.begin() + static_cast<ptrdiff_t>(capacity_), new_buffer.begin());
+            BufferPool::release(std::move(buffer_));
+
+            buffer_ = std::move(new_buffer);
+            capacity_ = buffer_.size();
         }
     }
+
+    // drops content and gives memory back to the pool
+    void reset_capacity(buffer_size_t capacity) {
+        BufferPool::release(std::move(buffer_));
+
+        buffer_ = BufferPool::acquire(capacity);
+        capacity_ = buffer_.size();
+        size_ = 0;
+    }
 };
 
 #endif //ROBOTS_BUFFER_H
@@ -0,0 +1,78 @@
+#include "buffer_pool.h"
+#include <bit>
+
+using namespace std;
+
+atomic<uint64_t> BufferPool::allocations_{0};
+atomic<uint64_t> BufferPool::reuses_{0};
+atomic<uint64_t> BufferPool::releases_{0};
+atomic<uint64_t> BufferPool::drops_{0};
+
+size_t BufferPool::get_class_index(size_t size) {
+    if (size <= MIN_CLASS_SIZE) {
+        return 0;
+    }
+
+    return static_cast<size_t>(bit_width(size - 1) - bit_width(MIN_CLASS_SIZE - 1));
+}
+
+BufferPool::FreeLists &BufferPool::get_free_lists() {
+    thread_local FreeLists free_lists{};
+    return free_lists;
+}
+
+BufferPool::bytes_t BufferPool::acquire(size_t needed_size) {
+    size_t class_index = get_class_index(needed_size);
+
+    if (class_index >= CLASSES_NO) {
+        allocations_.fetch_add(1, memory_order_relaxed);
+        return bytes_t(needed_size);
+    }
+
+    FreeLists &free_lists = get_free_lists();
+    auto &free_list = free_lists.lists[class_index];
+    if (!free_list.empty()) {
+        bytes_t result = move(free_list.back());
+        free_list.pop_back();
+        free_lists.cached_bytes -= result.size();
+        reuses_.fetch_add(1, memory_order_relaxed);
+        return result;
+    }
+
+    allocations_.fetch_add(1, memory_order_relaxed);
+    return bytes_t(MIN_CLASS_SIZE << class_index);
+}
+
+void BufferPool::release(bytes_t &&bytes) {
+    if (bytes.empty()) { // moved-from buffer
+        return;
+    }
+
+    size_t class_index = get_class_index(bytes.size());
+    if (class_index >= CLASSES_NO || (MIN_CLASS_SIZE << class_index) != bytes.size()) {
+        drops_.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    FreeLists &free_lists = get_free_lists();
+    auto &free_list = free_lists.lists[class_index];
+    if (free_list.size() >= MAX_CACHED_PER_CLASS
+        || free_lists.cached_bytes + bytes.size() > MAX_CACHED_BYTES_PER_THREAD) {
+        drops_.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+
+    free_lists.cached_bytes += bytes.size();
+    free_list.emplace_back(move(bytes));
+    releases_.fetch_add(1, memory_order_relaxed);
+}
+
+BufferPool::Stats BufferPool::get_stats() {
+    return Stats{allocations_.load(memory_order_relaxed), reuses_.load(memory_order_relaxed),
+                 releases_.load(memory_order_relaxed), drops_.load(memory_order_relaxed)};
+}
+
+ostream &operator<<(ostream &os, const BufferPool::Stats &stats) {
+    return os << "allocations: " << stats.allocations << ", reuses: " << stats.reuses
+              << ", releases: " << stats.releases << ", drops: " << stats.drops;
+}
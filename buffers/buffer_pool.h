@@ -0,0 +1,58 @@
+#ifndef ROBOTS_BUFFER_POOL_H
+#define ROBOTS_BUFFER_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+// Pool of byte vectors grouped in power-of-two size classes.
+// Released vectors are kept per thread and handed out again without
+// being zero-filled, so small messages get small, recycled buffers.
+// Buffers are often released by other threads than the ones taking them,
+// so every thread keeps only a limited number of bytes.
+class BufferPool {
+public:
+    using bytes_t = std::vector<uint8_t>;
+
+    struct Stats {
+        uint64_t allocations;
+        uint64_t reuses;
+        uint64_t releases;
+        uint64_t drops;
+
+        friend std::ostream &operator<<(std::ostream &os, const Stats &stats);
+    };
+
+    static constexpr size_t MIN_CLASS_SIZE = 64;
+    // the largest class fits a chunk of OutgoingLog
+    static constexpr size_t CLASSES_NO = 13;
+    static constexpr size_t MAX_CACHED_PER_CLASS = 64;
+    static constexpr size_t MAX_CACHED_BYTES_PER_THREAD = 8 << 20;
+
+    // Result has size() equal to the smallest size class fitting needed_size,
+    // bigger requests than the largest class get exactly needed_size bytes
+    static bytes_t acquire(size_t needed_size);
+    static void release(bytes_t &&bytes);
+
+    // Counters of all threads, server logs them after every game
+    // and on shutdown, client on shutdown
+    static Stats get_stats();
+
+private:
+    static std::atomic<uint64_t> allocations_;
+    static std::atomic<uint64_t> reuses_;
+    static std::atomic<uint64_t> releases_;
+    static std::atomic<uint64_t> drops_;
+
+    struct FreeLists {
+        std::array<std::vector<bytes_t>, CLASSES_NO> lists;
+        size_t cached_bytes;
+    };
+
+    static size_t get_class_index(size_t size);
+    static FreeLists &get_free_lists();
+};
+
+#endif //ROBOTS_BUFFER_POOL_H
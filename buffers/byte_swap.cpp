@@ -0,0 +1,67 @@
+#include "byte_swap.h"
+#include <cstring>
+#include <endian.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROBOTS_X86_SIMD
+#endif
+
+namespace {
+    void copy_swapping_uint16_scalar(uint8_t *dst, const uint8_t *src, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            uint16_t number;
+            memcpy(&number, src + 2 * i, sizeof(number));
+            number = static_cast<uint16_t>((number << 8) | (number >> 8));
+            memcpy(dst + 2 * i, &number, sizeof(number));
+        }
+    }
+
+#ifdef ROBOTS_X86_SIMD
+    __attribute__((target("sse2")))
+    void copy_swapping_uint16_sse2(uint8_t *dst, const uint8_t *src, size_t count) {
+        constexpr size_t NUMBERS_IN_VECTOR = sizeof(__m128i) / sizeof(uint16_t);
+        size_t i = 0;
+
+        for (; i + NUMBERS_IN_VECTOR <= count; i += NUMBERS_IN_VECTOR) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i), v);
+        }
+
+        copy_swapping_uint16_scalar(dst + 2 * i, src + 2 * i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    void copy_swapping_uint16_avx2(uint8_t *dst, const uint8_t *src, size_t count) {
+        constexpr size_t NUMBERS_IN_VECTOR = sizeof(__m256i) / sizeof(uint16_t);
+        const __m256i swap_mask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                   1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+        size_t i = 0;
+
+        for (; i + NUMBERS_IN_VECTOR <= count; i += NUMBERS_IN_VECTOR) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i));
+            v = _mm256_shuffle_epi8(v, swap_mask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i), v);
+        }
+
+        copy_swapping_uint16_sse2(dst + 2 * i, src + 2 * i, count - i);
+    }
+#endif
+}
+
+void copy_swapping_uint16(uint8_t *dst, const uint8_t *src, size_t count) {
+#if __BYTE_ORDER == __BIG_ENDIAN
+    memcpy(dst, src, count * sizeof(uint16_t));
+#elif defined(ROBOTS_X86_SIMD)
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+
+    if (has_avx2) {
+        copy_swapping_uint16_avx2(dst, src, count);
+    } else {
+        copy_swapping_uint16_sse2(dst, src, count);
+    }
+#else
+    copy_swapping_uint16_scalar(dst, src, count);
+#endif
+}
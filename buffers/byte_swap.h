@@ -0,0 +1,13 @@
+#ifndef ROBOTS_BYTE_SWAP_H
+#define ROBOTS_BYTE_SWAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Copies count uint16_t numbers from src to dst converting them between host
+// and network byte order, it's the same operation in both directions.
+// Uses AVX2 when processor supports it, SSE2 otherwise and scalar code
+// on other architectures. Memory doesn't have to be aligned.
+void copy_swapping_uint16(uint8_t *dst, const uint8_t *src, size_t count);
+
+#endif //ROBOTS_BYTE_SWAP_H
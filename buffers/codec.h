@@ -0,0 +1,392 @@
+#ifndef ROBOTS_CODEC_H
+#define ROBOTS_CODEC_H
+
+#include "byte_swap.h"
+#include "schema.h"
+#include <algorithm>
+#include <cstring>
+#include <endian.h>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Encoder, decoder and exact encoded size of every type described by Schema,
+// all of them generated at compile time from the same description
+namespace Codec {
+    constexpr size_t VARIABLE_SIZE = std::numeric_limits<size_t>::max();
+
+    template<typename T>
+    concept Integer = std::is_integral_v<T> || std::is_enum_v<T>;
+
+    template<typename T>
+    struct IsVector : std::false_type {};
+
+    template<typename E, typename A>
+    struct IsVector<std::vector<E, A>> : std::true_type {};
+
+    template<typename T>
+    struct IsPmrVector : std::false_type {};
+
+    template<typename E>
+    struct IsPmrVector<std::pmr::vector<E>> : std::true_type {};
+
+    template<typename T>
+    struct IsMap : std::false_type {};
+
+    template<typename K, typename V, typename H, typename E, typename A>
+    struct IsMap<std::unordered_map<K, V, H, E, A>> : std::true_type {};
+
+    template<typename T>
+    struct IsVariant : std::false_type {};
+
+    template<typename... Ts>
+    struct IsVariant<std::variant<Ts...>> : std::true_type {};
+
+    template<typename M>
+    struct MemberType;
+
+    template<typename C, typename F>
+    struct MemberType<F C::*> {
+        using type = F;
+    };
+
+    template<typename T, size_t I>
+    using field_t = typename MemberType<std::remove_cvref_t<
+            std::tuple_element_t<I, std::remove_cvref_t<decltype(Schema<T>::fields)>>>>::type;
+
+    template<typename T>
+    constexpr size_t fields_count = std::tuple_size_v<std::remove_cvref_t<decltype(Schema<T>::fields)>>;
+
+    // Size of encoded T when it's the same for all values, VARIABLE_SIZE otherwise
+    template<typename T>
+    constexpr size_t fixed_size();
+
+    template<typename T, size_t... I>
+    constexpr size_t schema_fixed_size(std::index_sequence<I...>) {
+        constexpr bool is_fixed = ((fixed_size<field_t<T, I>>() != VARIABLE_SIZE) && ...);
+        return is_fixed ? (fixed_size<field_t<T, I>>() + ... + 0) : VARIABLE_SIZE;
+    }
+
+    template<typename T>
+    constexpr size_t fixed_size() {
+        if constexpr (Integer<T>) {
+            return sizeof(T);
+        } else if constexpr (HasSchema<T>) {
+            return schema_fixed_size<T>(std::make_index_sequence<fields_count<T>>{});
+        } else {
+            return VARIABLE_SIZE;
+        }
+    }
+
+    template<typename T>
+    constexpr bool is_fixed_size = fixed_size<T>() != VARIABLE_SIZE;
+
+    template<typename T>
+    constexpr bool has_only_uint16_fields();
+
+    template<typename T, size_t... I>
+    constexpr bool schema_has_only_uint16_fields(std::index_sequence<I...>) {
+        return (has_only_uint16_fields<field_t<T, I>>() && ...);
+    }
+
+    template<typename T>
+    constexpr bool has_only_uint16_fields() {
+        if constexpr (Integer<T>) {
+            return sizeof(T) == sizeof(uint16_t);
+        } else if constexpr (HasSchema<T>) {
+            return schema_has_only_uint16_fields<T>(std::make_index_sequence<fields_count<T>>{});
+        } else {
+            return false;
+        }
+    }
+
+    // Types kept in memory like on the wire, only with host byte order
+    // of their uint16_t fields, so their arrays are converted in bulk
+    template<typename T>
+    concept Uint16Layout = (std::is_same_v<T, uint16_t> || requires { Schema<T>::is_memory_layout; })
+                           && std::is_trivially_copyable_v<T>
+                           && sizeof(T) == fixed_size<T>()
+                           && has_only_uint16_fields<T>();
+
+    template<typename T>
+    concept ByteLayout = Integer<T> && sizeof(T) == sizeof(uint8_t);
+
+    // Writes to memory of already known size, so there are no bounds checks
+    class Writer {
+    public:
+        explicit Writer(uint8_t *data) : data_(data), index_(0) {}
+
+        size_t get_index() const {
+            return index_;
+        }
+
+        template<Integer T>
+        void write_integer(T value) {
+            if constexpr (std::is_enum_v<T>) {
+                write_integer(static_cast<std::underlying_type_t<T>>(value));
+            } else if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                data_[index_++] = static_cast<uint8_t>(value);
+            } else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                uint16_t number = htobe16(static_cast<uint16_t>(value));
+                write_bytes(&number, sizeof(number));
+            } else {
+                static_assert(sizeof(T) == sizeof(uint32_t));
+                uint32_t number = htobe32(static_cast<uint32_t>(value));
+                write_bytes(&number, sizeof(number));
+            }
+        }
+
+        void write_bytes(const void *bytes, size_t size) {
+            memcpy(data_ + index_, bytes, size);
+            index_ += size;
+        }
+
+        void write_uint16_array(const void *numbers, size_t count) {
+            copy_swapping_uint16(data_ + index_, static_cast<const uint8_t *>(numbers), count);
+            index_ += count * sizeof(uint16_t);
+        }
+
+    private:
+        uint8_t *data_;
+        size_t index_;
+    };
+
+    // Reads from memory of given size, bounds are checked explicitly by check_size,
+    // once for every fixed size part of the message. Decoded std::pmr vectors
+    // are allocated in given memory resource.
+    class Reader {
+    public:
+        Reader(const uint8_t *data, size_t size,
+               std::pmr::memory_resource *memory_resource = std::pmr::get_default_resource())
+                : data_(data), size_(size), index_(0), memory_resource_(memory_resource) {}
+
+        size_t get_index() const {
+            return index_;
+        }
+
+        std::pmr::memory_resource *get_memory_resource() const {
+            return memory_resource_;
+        }
+
+        size_t get_remaining() const {
+            return size_ - index_;
+        }
+
+        // throws length_error when there's less than needed_size bytes left
+        void check_size(size_t needed_size) const {
+            if (needed_size > size_ - index_) {
+                throw std::length_error("message to short");
+            }
+        }
+
+        template<Integer T>
+        T read_integer() {
+            if constexpr (std::is_enum_v<T>) {
+                return static_cast<T>(read_integer<std::underlying_type_t<T>>());
+            } else if constexpr (sizeof(T) == sizeof(uint8_t)) {
+                return static_cast<T>(data_[index_++]);
+            } else if constexpr (sizeof(T) == sizeof(uint16_t)) {
+                uint16_t number;
+                memcpy(&number, read_bytes(sizeof(number)), sizeof(number));
+                return static_cast<T>(be16toh(number));
+            } else {
+                static_assert(sizeof(T) == sizeof(uint32_t));
+                uint32_t number;
+                memcpy(&number, read_bytes(sizeof(number)), sizeof(number));
+                return static_cast<T>(be32toh(number));
+            }
+        }
+
+        const uint8_t *read_bytes(size_t size) {
+            const uint8_t *result = data_ + index_;
+            index_ += size;
+            return result;
+        }
+
+        void read_uint16_array(void *numbers, size_t count) {
+            copy_swapping_uint16(static_cast<uint8_t *>(numbers), read_bytes(count * sizeof(uint16_t)), count);
+        }
+
+    private:
+        const uint8_t *data_;
+        size_t size_;
+        size_t index_;
+        std::pmr::memory_resource *memory_resource_;
+    };
+
+    template<typename T>
+    size_t encoded_size(const T &value) {
+        if constexpr (is_fixed_size<T>) {
+            return fixed_size<T>();
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return sizeof(uint8_t) + std::min<size_t>(value.size(), UINT8_MAX);
+        } else if constexpr (IsVector<T>::value) {
+            using element_t = typename T::value_type;
+            if constexpr (is_fixed_size<element_t>) {
+                return sizeof(uint32_t) + value.size() * fixed_size<element_t>();
+            } else {
+                size_t result = sizeof(uint32_t);
+                for (auto &element: value) {
+                    result += encoded_size(element);
+                }
+                return result;
+            }
+        } else if constexpr (IsMap<T>::value) {
+            using key_t = typename T::key_type;
+            using mapped_t = typename T::mapped_type;
+            if constexpr (is_fixed_size<key_t> && is_fixed_size<mapped_t>) {
+                return sizeof(uint32_t) + value.size() * (fixed_size<key_t>() + fixed_size<mapped_t>());
+            } else {
+                size_t result = sizeof(uint32_t);
+                for (auto &[key, mapped]: value) {
+                    result += encoded_size(key) + encoded_size(mapped);
+                }
+                return result;
+            }
+        } else if constexpr (IsVariant<T>::value) {
+            return sizeof(uint8_t) + std::visit([](auto &alternative) { return encoded_size(alternative); }, value);
+        } else {
+            return std::apply([&value](auto... member) { return (encoded_size(value.*member) + ... + 0); },
+                              Schema<T>::fields);
+        }
+    }
+
+    // Writer has to have at least encoded_size(value) bytes of space
+    template<typename T>
+    void encode(Writer &writer, const T &value) {
+        if constexpr (Integer<T>) {
+            writer.write_integer(value);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            auto length = static_cast<uint8_t>(std::min<size_t>(value.size(), UINT8_MAX));
+            writer.write_integer(length);
+            writer.write_bytes(value.data(), length);
+        } else if constexpr (IsVector<T>::value) {
+            using element_t = typename T::value_type;
+            writer.write_integer(static_cast<uint32_t>(value.size()));
+
+            if constexpr (ByteLayout<element_t>) {
+                writer.write_bytes(value.data(), value.size());
+            } else if constexpr (Uint16Layout<element_t>) {
+                writer.write_uint16_array(value.data(), value.size() * sizeof(element_t) / sizeof(uint16_t));
+            } else {
+                for (auto &element: value) {
+                    encode(writer, element);
+                }
+            }
+        } else if constexpr (IsMap<T>::value) {
+            writer.write_integer(static_cast<uint32_t>(value.size()));
+            for (auto &[key, mapped]: value) {
+                encode(writer, key);
+                encode(writer, mapped);
+            }
+        } else if constexpr (IsVariant<T>::value) {
+            writer.write_integer(static_cast<uint8_t>(value.index()));
+            std::visit([&writer](auto &alternative) { encode(writer, alternative); }, value);
+        } else {
+            std::apply([&writer, &value](auto... member) { (encode(writer, value.*member), ...); },
+                       Schema<T>::fields);
+        }
+    }
+
+    // Only for fixed size types, bounds have to be checked before
+    template<typename T>
+    void decode_unchecked(Reader &reader, T &value) {
+        static_assert(is_fixed_size<T>);
+
+        if constexpr (Integer<T>) {
+            value = reader.read_integer<T>();
+        } else {
+            std::apply([&reader, &value](auto... member) { (decode_unchecked(reader, value.*member), ...); },
+                       Schema<T>::fields);
+        }
+    }
+
+    template<typename T>
+    void decode(Reader &reader, T &value);
+
+    template<typename T, size_t... I>
+    void decode_variant(Reader &reader, T &value, uint8_t index, std::index_sequence<I...>) {
+        bool is_index_correct = ((index == I ? (decode(reader, value.template emplace<I>()), true) : false) || ...);
+
+        if (!is_index_correct) {
+            throw std::invalid_argument("bad variant index");
+        }
+    }
+
+    // throws length_error when message is too short
+    // and invalid_argument when variant index is incorrect
+    template<typename T>
+    void decode(Reader &reader, T &value) {
+        if constexpr (is_fixed_size<T>) {
+            reader.check_size(fixed_size<T>());
+            decode_unchecked(reader, value);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            reader.check_size(sizeof(uint8_t));
+            auto length = reader.read_integer<uint8_t>();
+            reader.check_size(length);
+            value.assign(reinterpret_cast<const char *>(reader.read_bytes(length)), length);
+        } else if constexpr (IsVector<T>::value) {
+            using element_t = typename T::value_type;
+            reader.check_size(sizeof(uint32_t));
+            auto count = reader.read_integer<uint32_t>();
+
+            // allocator of pmr vector can't be changed by assignment, so it's created again
+            if constexpr (IsPmrVector<T>::value) {
+                if (value.get_allocator().resource() != reader.get_memory_resource()) {
+                    std::destroy_at(&value);
+                    std::construct_at(&value, reader.get_memory_resource());
+                }
+            }
+
+            if constexpr (is_fixed_size<element_t>) {
+                reader.check_size(count * fixed_size<element_t>());
+                value.resize(count);
+
+                if constexpr (ByteLayout<element_t>) {
+                    memcpy(value.data(), reader.read_bytes(count), count);
+                } else if constexpr (Uint16Layout<element_t>) {
+                    reader.read_uint16_array(value.data(), count * sizeof(element_t) / sizeof(uint16_t));
+                } else {
+                    for (auto &element: value) {
+                        decode_unchecked(reader, element);
+                    }
+                }
+            } else {
+                value.clear();
+                value.reserve(std::min<size_t>(count, reader.get_remaining()));
+                for (size_t i = 0; i < count; i++) {
+                    decode(reader, value.emplace_back());
+                }
+            }
+        } else if constexpr (IsMap<T>::value) {
+            reader.check_size(sizeof(uint32_t));
+            auto count = reader.read_integer<uint32_t>();
+
+            value.clear();
+            value.reserve(std::min<size_t>(count, reader.get_remaining()));
+            for (size_t i = 0; i < count; i++) {
+                typename T::key_type key{};
+                typename T::mapped_type mapped{};
+                decode(reader, key);
+                decode(reader, mapped);
+                value.emplace(key, std::move(mapped));
+            }
+        } else if constexpr (IsVariant<T>::value) {
+            reader.check_size(sizeof(uint8_t));
+            auto index = reader.read_integer<uint8_t>();
+            decode_variant(reader, value, index, std::make_index_sequence<std::variant_size_v<T>>{});
+        } else {
+            std::apply([&reader, &value](auto... member) { (decode(reader, value.*member), ...); },
+                       Schema<T>::fields);
+        }
+    }
+}
+
+#endif //ROBOTS_CODEC_H
@@ -0,0 +1,87 @@
+#include "draw_frame_buffer.h"
+#include "../logger.h"
+
+using namespace std;
+
+DrawFrameBuffer::DrawFrameBuffer() : IncomingBuffer(), has_frame_(false), is_frame_read_(false), frame_(0),
+                                     received_count_(0), received_(), dropped_frames_(0) {}
+
+void DrawFrameBuffer::add_packet(vector<uint8_t> &data, buffer_size_t size) {
+    if (size < DrawMessage::Fragment::HEADER_LENGTH) {
+        return;
+    }
+
+    DrawMessage::Fragment fragment{};
+    Codec::Reader reader(data.data(), size, memory_resource_);
+    Codec::decode(reader, fragment);
+
+    buffer_size_t payload_size = size - DrawMessage::Fragment::HEADER_LENGTH;
+    bool is_last = fragment.index + 1 == fragment.count;
+    if (fragment.index >= fragment.count || payload_size > DrawMessage::Fragment::MAX_PAYLOAD
+        || (!is_last && payload_size != DrawMessage::Fragment::MAX_PAYLOAD)) {
+        return;
+    }
+    // count comes from the datagram, so it can't make the buffer arbitrarily big
+    if (fragment.count * DrawMessage::Fragment::MAX_PAYLOAD > DrawMessage::Fragment::MAX_FRAME_SIZE) {
+        return;
+    }
+
+    if (!has_frame_ || is_newer_frame(fragment.frame)) {
+        start_frame(fragment);
+    } else if (fragment.frame != frame_ || fragment.count != received_.size() || received_[fragment.index]) {
+        return;
+    }
+
+    buffer_size_t offset = fragment.index * DrawMessage::Fragment::MAX_PAYLOAD;
+    resize_if_needed(offset + payload_size);
+    copy(&data[DrawMessage::Fragment::HEADER_LENGTH], &data[size], &buffer_[offset]);
+
+    if (is_last) {
+        size_ = offset + payload_size;
+    }
+    received_[fragment.index] = true;
+    received_count_++;
+}
+
+ReadStatus DrawFrameBuffer::try_read_draw_message(DrawMessage::draw_message &result) {
+    if (!has_frame_ || is_frame_read_ || received_count_ != received_.size()) {
+        return ReadStatus::NEED_MORE;
+    }
+
+    is_frame_read_ = true;
+    read_index = 0;
+    try {
+        read_value(result);
+    } catch (exception &e) {
+        Logger::print_debug("malformed draw frame ", frame_, " - ", e.what());
+        return ReadStatus::MALFORMED;
+    }
+
+    return read_index == size_ ? ReadStatus::COMPLETE : ReadStatus::MALFORMED;
+}
+
+uint32_t DrawFrameBuffer::get_frame() const {
+    return frame_;
+}
+
+uint64_t DrawFrameBuffer::get_dropped_frames() const {
+    return dropped_frames_;
+}
+
+void DrawFrameBuffer::start_frame(const DrawMessage::Fragment &fragment) {
+    if (has_frame_ && !is_frame_read_) {
+        dropped_frames_++;
+    }
+
+    has_frame_ = true;
+    is_frame_read_ = false;
+    frame_ = fragment.frame;
+    received_count_ = 0;
+    received_.assign(fragment.count, false);
+    size_ = 0;
+}
+
+bool DrawFrameBuffer::is_newer_frame(uint32_t frame) const {
+    // frame numbers can wrap around
+    return static_cast<int32_t>(frame - frame_) > 0;
+}
@@ -0,0 +1,40 @@
+#ifndef ROBOTS_DRAW_FRAME_BUFFER_H
+#define ROBOTS_DRAW_FRAME_BUFFER_H
+
+#include "../structures.h"
+#include "incoming_buffer.h"
+#include <vector>
+
+// Class for putting together draws sent by UDP in fragments. Only the newest
+// frame is kept - fragments of older frames are ignored and a frame, which
+// wasn't read, is dropped when a fragment of a newer one comes.
+class DrawFrameBuffer : public IncomingBuffer {
+public:
+    static_assert(DrawMessage::Fragment::HEADER_LENGTH == Codec::fixed_size<DrawMessage::Fragment>());
+    static_assert(DrawMessage::Fragment::HEADER_LENGTH + DrawMessage::Fragment::MAX_PAYLOAD == MAX_PACKET_LENGTH);
+
+    DrawFrameBuffer();
+
+    // Incorrect fragments and fragments of frames bigger than MAX_FRAME_SIZE
+    // are ignored, it's udp
+    void add_packet(std::vector<uint8_t> &data, buffer_size_t size) override;
+    // COMPLETE, when all fragments of the frame came, result is set only then
+    // and every frame is read once, MALFORMED when frame isn't a draw message
+    ReadStatus try_read_draw_message(DrawMessage::draw_message &result);
+
+    uint32_t get_frame() const;
+    uint64_t get_dropped_frames() const;
+
+private:
+    bool has_frame_;
+    bool is_frame_read_;
+    uint32_t frame_;
+    uint16_t received_count_;
+    std::vector<bool> received_;
+    uint64_t dropped_frames_;
+
+    void start_frame(const DrawMessage::Fragment &fragment);
+    bool is_newer_frame(uint32_t frame) const;
+};
+
+#endif //ROBOTS_DRAW_FRAME_BUFFER_H
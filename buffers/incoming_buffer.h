@@ -2,9 +2,9 @@
 #define ROBOTS_INCOMING_BUFFER_H
 
 #include "../structures.h"
-#include <vector>
-#include <unordered_map>
 #include "buffer.h"
+#include "codec.h"
+#include <vector>
 
 // Class for storing and parsing incoming messages
 class IncomingBuffer : public Buffer {
@@ -13,34 +13,19 @@ public:
 
 protected:
     buffer_size_t read_index;
+    std::pmr::memory_resource *memory_resource_;
 
     IncomingBuffer();
     void add_to_buffer(std::vector<uint8_t> &data, buffer_size_t size);
 
-    uint8_t read_uint8_t();
-    uint16_t read_uint16_t();
-    uint32_t read_uint32_t();
-    std::string read_string();
-
-    Player read_player();
-    Position read_position();
-
-    Event::BombPlacedEvent read_bomb_placed_event();
-    Event::BombExplodedEvent read_bomb_exploded_event();
-    Event::PlayerMovedEvent read_player_moved_event();
-    Event::BlockPlacedEvent read_block_placed_event();
-
-    Event::event_message read_event();
-
-    std::vector<Event::event_message> read_events_vector();
-    std::vector<player_id_t> read_players_id_vector();
-    std::vector<Position> read_positions_vector();
-    std::unordered_map<player_id_t, Player> read_players_map();
-    std::unordered_map<player_id_t, score_t> read_player_scores_map();
-
-private:
-    //throws length_error when wrong length
-    void check_size(buffer_size_t needed_size);
+    // Decodes value starting at read_index and moves read_index after it,
+    // throws length_error when value doesn't fit in the buffer
+    template<typename T>
+    void read_value(T &value) {
+        Codec::Reader reader(buffer_.data() + read_index, size_ - read_index, memory_resource_);
+        Codec::decode(reader, value);
+        read_index += reader.get_index();
+    }
 };
 
 
@@ -0,0 +1,202 @@
+#include "message_scanner.h"
+#include "codec.h"
+#include <cstring>
+
+using namespace std;
+
+MessageScanner::MessageScanner() : stack_(), index_(0), is_malformed_(false) {}
+
+bool MessageScanner::is_scanning() const {
+    return !stack_.empty() || index_ != 0 || is_malformed_;
+}
+
+void MessageScanner::start(Root root) {
+    reset();
+    stack_.push_back({root == Root::SERVER_MESSAGE ? Item::SERVER_MESSAGE : Item::CLIENT_MESSAGE, Item::SKIP, 0});
+}
+
+void MessageScanner::reset() {
+    stack_.clear();
+    index_ = 0;
+    is_malformed_ = false;
+}
+
+size_t MessageScanner::get_message_size() const {
+    return index_;
+}
+
+size_t MessageScanner::get_fixed_size(Item item) {
+    switch (item) {
+        case Item::PLAYER_ID:
+            return Codec::fixed_size<player_id_t>();
+        case Item::POSITION:
+            return Codec::fixed_size<Position>();
+        case Item::SCORE_ENTRY:
+            return Codec::fixed_size<player_id_t>() + Codec::fixed_size<score_t>();
+        default:
+            return 0;
+    }
+}
+
+void MessageScanner::push_skip(size_t bytes) {
+    if (bytes > 0) {
+        stack_.push_back({Item::SKIP, Item::SKIP, bytes});
+    }
+}
+
+void MessageScanner::push_list(Item element) {
+    stack_.push_back({Item::LIST_HEADER, element, 0});
+}
+
+// bodies are pushed in reverse order, top of the stack is scanned first
+bool MessageScanner::push_server_message_body(message_id_t type) {
+    switch (type) {
+        case ServerMessage::HELLO:
+            // everything after server name has fixed size
+            push_skip(Codec::encoded_size(ServerMessage::Hello{}) - Codec::encoded_size(string()));
+            stack_.push_back({Item::STRING, Item::SKIP, 0});
+            return true;
+        case ServerMessage::ACCEPTED_PLAYER:
+            stack_.push_back({Item::PLAYER, Item::SKIP, 0});
+            push_skip(Codec::fixed_size<player_id_t>());
+            return true;
+        case ServerMessage::GAME_STARTED:
+            push_list(Item::PLAYER_ENTRY);
+            return true;
+        case ServerMessage::TURN:
+            push_list(Item::EVENT);
+            push_skip(Codec::fixed_size<decltype(ServerMessage::Turn::turn)>());
+            return true;
+        case ServerMessage::GAME_ENDED:
+            push_list(Item::SCORE_ENTRY);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool MessageScanner::push_client_message_body(message_id_t type) {
+    switch (type) {
+        case ClientMessage::JOIN:
+            stack_.push_back({Item::STRING, Item::SKIP, 0});
+            return true;
+        case ClientMessage::PLACE_BOMB:
+        case ClientMessage::PLACE_BLOCK:
+            return true;
+        case ClientMessage::MOVE:
+            push_skip(Codec::fixed_size<ClientMessage::Move>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool MessageScanner::push_event_body(event_id_t type) {
+    switch (type) {
+        case Event::BOMB_PLACED:
+            push_skip(Codec::fixed_size<Event::BombPlacedEvent>());
+            return true;
+        case Event::BOMB_EXPLODED:
+            push_list(Item::POSITION);
+            push_list(Item::PLAYER_ID);
+            push_skip(Codec::fixed_size<bomb_id_t>());
+            return true;
+        case Event::PLAYER_MOVED:
+            push_skip(Codec::fixed_size<Event::PlayerMovedEvent>());
+            return true;
+        case Event::BLOCK_PLACED:
+            push_skip(Codec::fixed_size<Event::BlockPlacedEvent>());
+            return true;
+        default:
+            return false;
+    }
+}
+
+ReadStatus MessageScanner::scan(const uint8_t *data, size_t size) {
+    if (is_malformed_) {
+        return ReadStatus::MALFORMED;
+    }
+
+    while (!stack_.empty()) {
+        Frame frame = stack_.back();
+
+        if (frame.item == Item::SKIP) {
+            if (index_ + frame.remaining > size) {
+                stack_.back().remaining -= size - index_;
+                index_ = size;
+                return ReadStatus::NEED_MORE;
+            }
+
+            index_ += frame.remaining;
+            stack_.pop_back();
+            continue;
+        }
+
+        if (frame.item == Item::LIST) {
+            size_t element_size = get_fixed_size(frame.element);
+            stack_.pop_back();
+
+            if (element_size > 0) {
+                push_skip(element_size * frame.remaining);
+            } else if (frame.remaining > 0) {
+                stack_.push_back({Item::LIST, frame.element, frame.remaining - 1});
+                stack_.push_back({frame.element, Item::SKIP, 0});
+            }
+            continue;
+        }
+
+        if (frame.item == Item::PLAYER) {
+            stack_.pop_back();
+            stack_.push_back({Item::STRING, Item::SKIP, 0});
+            stack_.push_back({Item::STRING, Item::SKIP, 0});
+            continue;
+        }
+
+        if (frame.item == Item::PLAYER_ENTRY) {
+            stack_.pop_back();
+            stack_.push_back({Item::PLAYER, Item::SKIP, 0});
+            push_skip(Codec::fixed_size<player_id_t>());
+            continue;
+        }
+
+        // all other items start with a header, which has to be read first
+        size_t header_size = (frame.item == Item::LIST_HEADER) ? sizeof(uint32_t) : sizeof(uint8_t);
+        if (index_ + header_size > size) {
+            return ReadStatus::NEED_MORE;
+        }
+
+        stack_.pop_back();
+        bool is_type_correct = true;
+        switch (frame.item) {
+            case Item::STRING:
+                push_skip(data[index_]);
+                break;
+            case Item::LIST_HEADER: {
+                uint32_t count;
+                memcpy(&count, &data[index_], sizeof(count));
+                count = be32toh(count);
+                stack_.push_back({Item::LIST, frame.element, count});
+                break;
+            }
+            case Item::EVENT:
+                is_type_correct = push_event_body(data[index_]);
+                break;
+            case Item::SERVER_MESSAGE:
+                is_type_correct = push_server_message_body(data[index_]);
+                break;
+            case Item::CLIENT_MESSAGE:
+                is_type_correct = push_client_message_body(data[index_]);
+                break;
+            default:
+                is_type_correct = false;
+        }
+
+        if (!is_type_correct) {
+            is_malformed_ = true;
+            return ReadStatus::MALFORMED;
+        }
+        index_ += header_size;
+    }
+
+    return ReadStatus::COMPLETE;
+}
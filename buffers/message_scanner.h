@@ -0,0 +1,72 @@
+#ifndef ROBOTS_MESSAGE_SCANNER_H
+#define ROBOTS_MESSAGE_SCANNER_H
+
+#include "../structures.h"
+#include "buffer.h"
+#include <cstdint>
+#include <vector>
+
+// Resumable state machine finding where a TCP message ends.
+// It keeps its progress between packets, so the bytes of an incomplete
+// message are looked at only once and the message is decoded only after
+// all of it has arrived. Fixed size parts (e.g. lists of positions)
+// are skipped without looking at their content.
+class MessageScanner {
+public:
+    enum class Root : uint8_t {
+        SERVER_MESSAGE,
+        CLIENT_MESSAGE,
+    };
+
+    MessageScanner();
+
+    bool is_scanning() const;
+    void start(Root root);
+
+    // Continues scanning data[0..size), message is COMPLETE when all of it
+    // is available and MALFORMED when it has unknown message or event type,
+    // MALFORMED is returned until reset
+    ReadStatus scan(const uint8_t *data, size_t size);
+
+    // Size of scanned message, valid after scan returned COMPLETE
+    size_t get_message_size() const;
+
+    void reset();
+
+private:
+    enum class Item : uint8_t {
+        SKIP,
+        STRING,
+        PLAYER,
+        PLAYER_ID,
+        POSITION,
+        PLAYER_ENTRY,
+        SCORE_ENTRY,
+        EVENT,
+        LIST_HEADER,
+        LIST,
+        SERVER_MESSAGE,
+        CLIENT_MESSAGE,
+    };
+
+    struct Frame {
+        Item item;
+        Item element;
+        size_t remaining;
+    };
+
+    std::vector<Frame> stack_;
+    size_t index_;
+    bool is_malformed_;
+
+    static size_t get_fixed_size(Item item);
+
+    void push_skip(size_t bytes);
+    void push_list(Item element);
+    // return false for unknown types
+    bool push_server_message_body(message_id_t type);
+    bool push_client_message_body(message_id_t type);
+    bool push_event_body(event_id_t type);
+};
+
+#endif //ROBOTS_MESSAGE_SCANNER_H
@@ -3,62 +3,37 @@
 
 #include "../structures.h"
 #include "buffer.h"
+#include <memory>
 #include <vector>
-#include <unordered_map>
 
-// Class for storing and parsing outgoing message,
-// supposed to keep at most only one message at the time
+// Class for storing encoded outgoing message of exactly its size,
+// or a few encoded messages appended one after another
 class OutgoingBuffer : public Buffer {
 public:
-    explicit OutgoingBuffer(DrawMessage::draw_message &msg);
-    explicit OutgoingBuffer(ClientMessage::client_message &msg);
-    explicit OutgoingBuffer(ServerMessage::server_message &msg);
-
-    buffer_size_t size();
-    uint8_t *get_buffer();
-
-protected:
-    buffer_size_t write_index;
-
-    void write_uint8_t(uint8_t number);
-    void write_uint16_t(uint16_t number);
-    void write_uint32_t(uint32_t number);
-    void write_string(std::string &string);
-
-    void write_player(Player &player);
-    void write_position(Position &position);
-    void write_bomb(Bomb &bomb);
-
-    void write_bomb_placed_event(Event::BombPlacedEvent &event);
-    void write_bomb_exploded_event(Event::BombExplodedEvent &event);
-    void write_player_moved_event(Event::PlayerMovedEvent &event);
-    void write_block_placed_event(Event::BlockPlacedEvent &event);
-
-    void write_event(Event::event_message &event);
-
-    void write_players_id_vector(std::vector<player_id_t> &player_ids);
-    void write_positions_vector(std::vector<Position> &positions);
-    void write_bombs_vector(std::vector<Bomb> &bombs);
-    void write_events_vector(std::vector<Event::event_message> &events);
-
-    void write_players_map(std::unordered_map<player_id_t, Player> &players);
-    void write_player_positions_map(std::unordered_map<player_id_t, Position> &player_positions);
-    void write_player_scores_map(std::unordered_map<player_id_t, score_t> &scores);
-
-    void write_draw_lobby_message(DrawMessage::Lobby &msg);
-    void write_draw_game_message(DrawMessage::Game &msg);
-
-    void write_client_join_message(ClientMessage::Join &msg);
-    void write_client_place_bomb_message();
-    void write_client_place_block_message();
-    void write_client_move_message(ClientMessage::Move &msg);
-
-    void write_server_hello_message(ServerMessage::Hello &msg);
-    void write_server_accepted_player_message(ServerMessage::AcceptedPlayer &msg);
-    void write_server_game_started_message(ServerMessage::GameStarted &msg);
-    void write_server_turn_message(ServerMessage::Turn &msg);
-    void write_server_game_ended_message(ServerMessage::GameEnded &msg);
+    explicit OutgoingBuffer(const DrawMessage::draw_message &msg);
+    explicit OutgoingBuffer(const ClientMessage::client_message &msg);
+    explicit OutgoingBuffer(const ServerMessage::server_message &msg);
+    // Empty buffer for already encoded messages
+    explicit OutgoingBuffer(buffer_size_t capacity);
+    // Header of fragment followed by part of an encoded draw
+    OutgoingBuffer(const DrawMessage::Fragment &fragment, const uint8_t *payload, buffer_size_t payload_size);
+
+    // Returns false, when there's no place for the message.
+    // Buffer can't be changed anymore after it's shared.
+    bool append(const OutgoingBuffer &msg);
+
+    buffer_size_t size() const;
+    const uint8_t *get_buffer() const;
+
+private:
+    template<typename T>
+    void write_message(const T &msg);
 };
 
+// Immutable encoded message, which can be queued by many connections at once
+using shared_outgoing_buffer = std::shared_ptr<const OutgoingBuffer>;
+
+// Splits encoded draw into fragments of frame, each fits in one datagram
+std::vector<shared_outgoing_buffer> split_into_fragments(const OutgoingBuffer &draw, uint32_t frame);
 
 #endif //ROBOTS_OUTGOING_BUFFER_H
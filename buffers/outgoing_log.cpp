@@ -0,0 +1,39 @@
+#include "outgoing_log.h"
+#include <algorithm>
+
+using namespace std;
+
+OutgoingLog::OutgoingLog() : full_chunks_(), last_chunk_(), last_chunk_copy_() {}
+
+void OutgoingLog::append(const OutgoingBuffer &msg) {
+    last_chunk_copy_.reset();
+
+    if (last_chunk_ != nullptr && last_chunk_->append(msg)) {
+        return;
+    }
+
+    if (last_chunk_ != nullptr && last_chunk_->size() > 0) {
+        full_chunks_.emplace_back(move(last_chunk_));
+    }
+    last_chunk_ = make_unique<OutgoingBuffer>(max(CHUNK_SIZE, msg.size()));
+    last_chunk_->append(msg);
+}
+
+void OutgoingLog::clear() {
+    full_chunks_.clear();
+    last_chunk_.reset();
+    last_chunk_copy_.reset();
+}
+
+vector<shared_outgoing_buffer> OutgoingLog::get_chunks() {
+    vector<shared_outgoing_buffer> result = full_chunks_;
+
+    if (last_chunk_ != nullptr && last_chunk_->size() > 0) {
+        if (last_chunk_copy_ == nullptr) {
+            last_chunk_copy_ = make_shared<const OutgoingBuffer>(*last_chunk_);
+        }
+        result.emplace_back(last_chunk_copy_);
+    }
+
+    return result;
+}
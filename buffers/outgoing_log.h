@@ -0,0 +1,30 @@
+#ifndef ROBOTS_OUTGOING_LOG_H
+#define ROBOTS_OUTGOING_LOG_H
+
+#include "outgoing_buffer.h"
+#include <memory>
+#include <vector>
+
+// Append-only stream of encoded messages kept in big chunks. Full chunks
+// are never changed, so they're sent to any number of connections without
+// copying or encoding messages again. Only the last, not full chunk is
+// copied, once for all connections coming before the next message.
+class OutgoingLog {
+public:
+    static constexpr Buffer::buffer_size_t CHUNK_SIZE = 1 << 18;
+
+    OutgoingLog();
+
+    void append(const OutgoingBuffer &msg);
+    void clear();
+
+    // All appended messages, in order
+    std::vector<shared_outgoing_buffer> get_chunks();
+
+private:
+    std::vector<shared_outgoing_buffer> full_chunks_;
+    std::unique_ptr<OutgoingBuffer> last_chunk_;
+    shared_outgoing_buffer last_chunk_copy_;
+};
+
+#endif //ROBOTS_OUTGOING_LOG_H
@@ -0,0 +1,161 @@
+#ifndef ROBOTS_SCHEMA_H
+#define ROBOTS_SCHEMA_H
+
+#include "../structures.h"
+#include <tuple>
+
+// Wire format of structures, fields are sent in the listed order.
+// Integers are sent in big endian, strings with uint8_t length,
+// vectors and maps with uint32_t size and variants with uint8_t index.
+template<typename T>
+struct Schema;
+
+template<typename T>
+concept HasSchema = requires { Schema<T>::fields; };
+
+template<>
+struct Schema<Player> {
+    static constexpr auto fields = std::make_tuple(&Player::name, &Player::address);
+};
+
+template<>
+struct Schema<Position> {
+    static constexpr auto fields = std::make_tuple(&Position::x, &Position::y);
+    // fields are declared in the same order, vectors are converted in bulk
+    static constexpr bool is_memory_layout = true;
+};
+
+template<>
+struct Schema<Bomb> {
+    static constexpr auto fields = std::make_tuple(&Bomb::position, &Bomb::timer);
+    // fields are declared in the same order, vectors are converted in bulk
+    static constexpr bool is_memory_layout = true;
+};
+
+template<>
+struct Schema<Event::BombPlacedEvent> {
+    static constexpr auto fields = std::make_tuple(&Event::BombPlacedEvent::id,
+                                                   &Event::BombPlacedEvent::position);
+};
+
+template<>
+struct Schema<Event::BombExplodedEvent> {
+    static constexpr auto fields = std::make_tuple(&Event::BombExplodedEvent::id,
+                                                   &Event::BombExplodedEvent::robots_destroyed,
+                                                   &Event::BombExplodedEvent::blocks_destroyed);
+};
+
+template<>
+struct Schema<Event::PlayerMovedEvent> {
+    static constexpr auto fields = std::make_tuple(&Event::PlayerMovedEvent::id,
+                                                   &Event::PlayerMovedEvent::position);
+};
+
+template<>
+struct Schema<Event::BlockPlacedEvent> {
+    static constexpr auto fields = std::make_tuple(&Event::BlockPlacedEvent::position);
+};
+
+template<>
+struct Schema<ClientMessage::Join> {
+    static constexpr auto fields = std::make_tuple(&ClientMessage::Join::name);
+};
+
+template<>
+struct Schema<ClientMessage::PlaceBomb> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template<>
+struct Schema<ClientMessage::PlaceBlock> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template<>
+struct Schema<ClientMessage::Move> {
+    static constexpr auto fields = std::make_tuple(&ClientMessage::Move::direction);
+};
+
+template<>
+struct Schema<DrawMessage::Lobby> {
+    static constexpr auto fields = std::make_tuple(&DrawMessage::Lobby::server_name_,
+                                                   &DrawMessage::Lobby::players_count_,
+                                                   &DrawMessage::Lobby::size_x_,
+                                                   &DrawMessage::Lobby::size_y,
+                                                   &DrawMessage::Lobby::game_length,
+                                                   &DrawMessage::Lobby::explosion_radius,
+                                                   &DrawMessage::Lobby::bomb_timer,
+                                                   &DrawMessage::Lobby::players);
+};
+
+template<>
+struct Schema<DrawMessage::Game> {
+    static constexpr auto fields = std::make_tuple(&DrawMessage::Game::server_name,
+                                                   &DrawMessage::Game::size_x,
+                                                   &DrawMessage::Game::size_y,
+                                                   &DrawMessage::Game::game_length,
+                                                   &DrawMessage::Game::turn,
+                                                   &DrawMessage::Game::players,
+                                                   &DrawMessage::Game::player_positions,
+                                                   &DrawMessage::Game::blocks,
+                                                   &DrawMessage::Game::bombs_,
+                                                   &DrawMessage::Game::explosions,
+                                                   &DrawMessage::Game::scores);
+};
+
+template<>
+struct Schema<DrawMessage::Fragment> {
+    static constexpr auto fields = std::make_tuple(&DrawMessage::Fragment::frame,
+                                                   &DrawMessage::Fragment::index,
+                                                   &DrawMessage::Fragment::count);
+};
+
+template<>
+struct Schema<ServerMessage::Hello> {
+    static constexpr auto fields = std::make_tuple(&ServerMessage::Hello::server_name,
+                                                   &ServerMessage::Hello::players_count,
+                                                   &ServerMessage::Hello::size_x,
+                                                   &ServerMessage::Hello::size_y,
+                                                   &ServerMessage::Hello::game_length,
+                                                   &ServerMessage::Hello::explosion_radius,
+                                                   &ServerMessage::Hello::bomb_timer);
+};
+
+template<>
+struct Schema<ServerMessage::AcceptedPlayer> {
+    static constexpr auto fields = std::make_tuple(&ServerMessage::AcceptedPlayer::id,
+                                                   &ServerMessage::AcceptedPlayer::player);
+};
+
+template<>
+struct Schema<ServerMessage::GameStarted> {
+    static constexpr auto fields = std::make_tuple(&ServerMessage::GameStarted::players);
+};
+
+template<>
+struct Schema<ServerMessage::Turn> {
+    static constexpr auto fields = std::make_tuple(&ServerMessage::Turn::turn,
+                                                   &ServerMessage::Turn::events);
+};
+
+template<>
+struct Schema<ServerMessage::GameEnded> {
+    static constexpr auto fields = std::make_tuple(&ServerMessage::GameEnded::scores);
+};
+
+template<>
+struct Schema<InputMessage::PlaceBomb> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template<>
+struct Schema<InputMessage::PlaceBlock> {
+    static constexpr auto fields = std::make_tuple();
+};
+
+template<>
+struct Schema<InputMessage::Move> {
+    static constexpr auto fields = std::make_tuple(&InputMessage::Move::direction);
+};
+
+#endif //ROBOTS_SCHEMA_H
@@ -3,134 +3,105 @@
 using namespace std;
 
 void TcpIncomingBuffer::add_packet(vector<uint8_t> &data, Buffer::buffer_size_t size) {
-    add_to_buffer(data, size);
-}
+    for (buffer_size_t added = 0; added < size;) {
+        span<uint8_t> free_space = get_free_space();
+        buffer_size_t part = min(size - added, free_space.size());
 
-void TcpIncomingBuffer::clean_after_correct_read() {
-    copy(&buffer_[read_index], &buffer_[size_], &buffer_[0]);
-    size_ -= read_index;
-    read_index = 0;
+        copy(&data[added], &data[added + part], free_space.data());
+        commit_packet(part);
+        added += part;
+    }
 }
 
-ServerMessage::server_message TcpIncomingBuffer::read_server_message() {
-    ServerMessage::server_message result;
-    read_index = 0;
-    switch (read_uint8_t()) {
-        case ServerMessage::HELLO: {
-            result = read_server_hello_message();
-            break;
-        }
-        case ServerMessage::ACCEPTED_PLAYER: {
-            result = read_server_accepted_player_message();
-            break;
-        }
-        case ServerMessage::GAME_STARTED: {
-            result = read_server_game_started_message();
-            break;
-        }
-        case ServerMessage::TURN: {
-            result = read_server_turn_message();
-            break;
-        }
-        case ServerMessage::GAME_ENDED: {
-            result = read_server_game_ended_message();
-            break;
-        }
-        default: {
-            throw invalid_argument("bad server message type");
-        }
+span<uint8_t> TcpIncomingBuffer::get_free_space() {
+    if (is_burst_ && capacity_ < MAX_BURST_CAPACITY) {
+        resize_if_needed(2 * capacity_);
     }
 
-    clean_after_correct_read();
-    return result;
-}
+    if (capacity_ - size_ < MIN_FREE_SPACE && read_index > 0) {
+        // only the beginning of not yet complete message is moved
+        copy(buffer_.data() + read_index, buffer_.data() + size_, buffer_.data());
+        size_ -= read_index;
+        read_index = 0;
+    }
 
-ClientMessage::client_message TcpIncomingBuffer::read_client_message() {
-    ClientMessage::client_message result;
-    read_index = 0;
-    switch (read_uint8_t()) {
-        case ClientMessage::JOIN: {
-            result = read_client_join_message();
-            break;
-        }
-        case ClientMessage::PLACE_BOMB: {
-            result = read_client_place_bomb_message();
-            break;
-        }
-        case ClientMessage::PLACE_BLOCK: {
-            result = read_client_place_block_message();
-            break;
-        }
-        case ClientMessage::MOVE: {
-            result = read_client_move_message();
-            break;
-        }
-        default: {
-            throw invalid_argument("bad client message type");
-        }
+    if (capacity_ - size_ < MIN_FREE_SPACE) {
+        resize_if_needed(size_ + MIN_FREE_SPACE);
     }
 
-    clean_after_correct_read();
-    return result;
+    return {buffer_.data() + size_, capacity_ - size_};
 }
 
-ServerMessage::Hello TcpIncomingBuffer::read_server_hello_message() {
-    string server_name = read_string();
-    uint8_t players_count = read_uint8_t();
-    uint16_t size_x = read_uint16_t();
-    uint16_t size_y = read_uint16_t();
-    uint16_t game_length = read_uint16_t();
-    uint16_t explosion_radius = read_uint16_t();
-    uint16_t bomb_timer = read_uint16_t();
-
-    return ServerMessage::Hello{server_name, players_count, size_x, size_y,
-                                game_length, explosion_radius, bomb_timer};
+void TcpIncomingBuffer::commit_packet(Buffer::buffer_size_t size) {
+    // whole free space filled - there's probably more data waiting in socket
+    is_burst_ = (size == capacity_ - size_);
+    size_ += size;
 }
 
-ServerMessage::AcceptedPlayer TcpIncomingBuffer::read_server_accepted_player_message() {
-    player_id_t id = read_uint8_t();
-    Player player = read_player();
+void TcpIncomingBuffer::clean_after_correct_read() {
+    scanner_.reset();
+
+    if (read_index == size_) {
+        read_index = 0;
+        size_ = 0;
 
-    return ServerMessage::AcceptedPlayer{id, player};
+        if (!is_burst_ && capacity_ > INITIAL_CAPACITY) {
+            reset_capacity(INITIAL_CAPACITY);
+        }
+    }
 }
 
-ServerMessage::GameStarted TcpIncomingBuffer::read_server_game_started_message() {
-    unordered_map<player_id_t, Player> players = read_players_map();
+ReadStatus TcpIncomingBuffer::check_message_available(MessageScanner::Root root) {
+    if (!scanner_.is_scanning()) {
+        scanner_.start(root);
+    }
 
-    return ServerMessage::GameStarted{players};
-}
+    ReadStatus status = scanner_.scan(buffer_.data() + read_index, size_ - read_index);
+    if (status == ReadStatus::NEED_MORE && size_ - read_index > MAX_CAPACITY) {
+        return ReadStatus::MALFORMED;
+    }
 
-ServerMessage::Turn TcpIncomingBuffer::read_server_turn_message() {
-    uint16_t turn = read_uint16_t();
-    vector<Event::event_message> events = read_events_vector();
-    
-    return ServerMessage::Turn{turn, events};
+    return status;
 }
 
-ServerMessage::GameEnded TcpIncomingBuffer::read_server_game_ended_message() {
-    unordered_map<player_id_t, score_t> scores = read_player_scores_map();
-    
-    return ServerMessage::GameEnded{scores};
-}
+ReadStatus TcpIncomingBuffer::try_read_server_message(ServerMessage::server_message &result) {
+    ReadStatus status = check_message_available(MessageScanner::Root::SERVER_MESSAGE);
+    if (status != ReadStatus::COMPLETE) {
+        return status;
+    }
 
-ClientMessage::Join TcpIncomingBuffer::read_client_join_message(){
-    string name = read_string();
-    
-    return ClientMessage::Join{name};
+    read_server_message(result);
+    return ReadStatus::COMPLETE;
 }
 
-ClientMessage::PlaceBomb TcpIncomingBuffer::read_client_place_bomb_message(){
-    return ClientMessage::PlaceBomb{};
-}
+void TcpIncomingBuffer::read_server_message(ServerMessage::server_message &result) {
+    // previous message is destroyed before its memory is released
+    result.emplace<ServerMessage::HELLO>();
+    if (message_arena_ == nullptr) {
+        message_arena_ = make_unique<TurnArena>();
+        memory_resource_ = message_arena_->get_resource();
+    }
+    message_arena_->release();
+
+    // scanner checked length and types, so reading can't fail
+    read_value(result);
 
-ClientMessage::PlaceBlock TcpIncomingBuffer::read_client_place_block_message(){
-    return ClientMessage::PlaceBlock{};
+    clean_after_correct_read();
 }
 
-ClientMessage::Move TcpIncomingBuffer::read_client_move_message(){
-    uint8_t direction_number = read_uint8_t();
-    
-    return ClientMessage::Move{Direction{direction_number}};
+ReadStatus TcpIncomingBuffer::try_read_client_message(ClientMessage::client_message &result) {
+    ReadStatus status = check_message_available(MessageScanner::Root::CLIENT_MESSAGE);
+    if (status != ReadStatus::COMPLETE) {
+        return status;
+    }
+
+    // scanner checked length and types, so reading can't fail
+    read_value(result);
+
+    clean_after_correct_read();
+    return ReadStatus::COMPLETE;
 }
 
-TcpIncomingBuffer::TcpIncomingBuffer() : IncomingBuffer() {}
+TcpIncomingBuffer::TcpIncomingBuffer() : IncomingBuffer(), scanner_(), is_burst_(false), message_arena_() {
+    reset_capacity(INITIAL_CAPACITY);
+}
@@ -2,28 +2,76 @@
 #define ROBOTS_TCP_INCOMING_BUFFER_H
 
 #include "../structures.h"
+#include "../turn_arena.h"
 #include "incoming_buffer.h"
+#include "message_scanner.h"
+#include "turn_reader.h"
+#include <memory>
+#include <span>
 
-// Class for storing and parsing incoming messages by TCP protocol
+// Class for storing and parsing incoming messages by TCP protocol.
+// Socket reads straight into the free space at the end of the buffer and
+// messages are decoded in place, the buffer is compacted only when the free
+// space runs out, grows during bursts and shrinks back when they're over.
 class TcpIncomingBuffer : public IncomingBuffer {
 public:
+    static constexpr buffer_size_t INITIAL_CAPACITY = 4096;
+    static constexpr buffer_size_t MIN_FREE_SPACE = 1024;
+    static constexpr buffer_size_t MAX_BURST_CAPACITY = 1 << 18;
+    static constexpr buffer_size_t MAX_CAPACITY = 1 << 24;
+
     TcpIncomingBuffer();
 
-    ServerMessage::server_message read_server_message();
-    ClientMessage::client_message read_client_message();
+    // Result is set only when COMPLETE is returned, message longer
+    // than MAX_CAPACITY is MALFORMED. Events of server messages are kept
+    // in arena reused by the next read, so result of previous read has
+    // to be the same object as result or already destroyed.
+    ReadStatus try_read_server_message(ServerMessage::server_message &result);
+    ReadStatus try_read_client_message(ClientMessage::client_message &result);
+
+    // Turn messages are passed to visitor.handle_turn(TurnReader &) and their
+    // events are decoded straight from the buffer while visitor reads them,
+    // other messages are passed decoded to visitor.handle_server_message
+    template<typename Visitor>
+    ReadStatus try_visit_server_message(Visitor &visitor) {
+        ReadStatus status = check_message_available(MessageScanner::Root::SERVER_MESSAGE);
+        if (status != ReadStatus::COMPLETE) {
+            return status;
+        }
+
+        if (buffer_[read_index] != ServerMessage::TURN) {
+            ServerMessage::server_message msg;
+            read_server_message(msg);
+            visitor.handle_server_message(std::move(msg));
+            return ReadStatus::COMPLETE;
+        }
+
+        size_t message_size = scanner_.get_message_size();
+        Codec::Reader reader(buffer_.data() + read_index + 1, message_size - 1);
+        TurnReader turn_reader(reader);
+        visitor.handle_turn(turn_reader);
+
+        // not visited events are skipped
+        read_index += message_size;
+        clean_after_correct_read();
+        return ReadStatus::COMPLETE;
+    }
+
     void add_packet(std::vector<uint8_t> &data, buffer_size_t size) override;
 
+    // Space for next read from socket
+    std::span<uint8_t> get_free_space();
+    // Marks first size bytes of free space as received
+    void commit_packet(buffer_size_t size);
+
 private:
-    ServerMessage::Hello read_server_hello_message();
-    ServerMessage::AcceptedPlayer read_server_accepted_player_message();
-    ServerMessage::GameStarted read_server_game_started_message();
-    ServerMessage::Turn read_server_turn_message();
-    ServerMessage::GameEnded read_server_game_ended_message();
-
-    ClientMessage::Join read_client_join_message();
-    static ClientMessage::PlaceBomb read_client_place_bomb_message();
-    static ClientMessage::PlaceBlock read_client_place_block_message();
-    ClientMessage::Move read_client_move_message();
+    MessageScanner scanner_;
+    bool is_burst_;
+    // created with the first server message, client messages don't need it
+    std::unique_ptr<TurnArena> message_arena_;
+
+    ReadStatus check_message_available(MessageScanner::Root root);
+    void read_server_message(ServerMessage::server_message &result);
 
     void clean_after_correct_read();
 };
@@ -0,0 +1,87 @@
+#ifndef ROBOTS_TURN_READER_H
+#define ROBOTS_TURN_READER_H
+
+#include "../structures.h"
+#include "codec.h"
+
+// Reads Turn message straight from the receive buffer and passes its events
+// to visitor one by one, without building vectors of events. Message has to
+// be already checked by MessageScanner, so bounds aren't checked again.
+//
+// Visitor has to provide:
+//   handle_bomb_placed(Event::BombPlacedEvent &)
+//   handle_bomb_exploded(bomb_id_t)
+//   handle_robot_destroyed(player_id_t)   - for every robot of last exploded bomb
+//   handle_block_destroyed(Position &)    - for every block of last exploded bomb
+//   handle_player_moved(Event::PlayerMovedEvent &)
+//   handle_block_placed(Event::BlockPlacedEvent &)
+class TurnReader {
+public:
+    // Reader starts right after the message type
+    explicit TurnReader(Codec::Reader &reader) : reader_(reader),
+                                                 turn_(reader.read_integer<uint16_t>()),
+                                                 events_count_(reader.read_integer<uint32_t>()) {}
+
+    uint16_t get_turn() const {
+        return turn_;
+    }
+
+    // Events can be visited only once
+    template<typename Visitor>
+    void visit_events(Visitor &visitor) {
+        for (; events_count_ > 0; events_count_--) {
+            switch (reader_.read_integer<event_id_t>()) {
+                case Event::BOMB_PLACED :
+                    visit_fixed_size<Event::BombPlacedEvent>([&visitor](auto &event) {
+                        visitor.handle_bomb_placed(event);
+                    });
+                    break;
+                case Event::BOMB_EXPLODED :
+                    visit_bomb_exploded(visitor);
+                    break;
+                case Event::PLAYER_MOVED :
+                    visit_fixed_size<Event::PlayerMovedEvent>([&visitor](auto &event) {
+                        visitor.handle_player_moved(event);
+                    });
+                    break;
+                case Event::BLOCK_PLACED :
+                    visit_fixed_size<Event::BlockPlacedEvent>([&visitor](auto &event) {
+                        visitor.handle_block_placed(event);
+                    });
+                    break;
+                default:
+                    // other types are rejected by MessageScanner
+                    return;
+            }
+        }
+    }
+
+private:
+    Codec::Reader &reader_;
+    uint16_t turn_;
+    uint32_t events_count_;
+
+    template<typename T, typename Handler>
+    void visit_fixed_size(Handler handler) {
+        T event;
+        Codec::decode_unchecked(reader_, event);
+        handler(event);
+    }
+
+    template<typename Visitor>
+    void visit_bomb_exploded(Visitor &visitor) {
+        visitor.handle_bomb_exploded(reader_.read_integer<bomb_id_t>());
+
+        for (auto count = reader_.read_integer<uint32_t>(); count > 0; count--) {
+            visitor.handle_robot_destroyed(reader_.read_integer<player_id_t>());
+        }
+
+        for (auto count = reader_.read_integer<uint32_t>(); count > 0; count--) {
+            Position block;
+            Codec::decode_unchecked(reader_, block);
+            visitor.handle_block_destroyed(block);
+        }
+    }
+};
+
+#endif //ROBOTS_TURN_READER_H
@@ -12,45 +12,29 @@ void UdpIncomingBuffer::reset_buffer() {
     size_ = 0;
 }
 
-InputMessage::input_message UdpIncomingBuffer::read_input_message() {
-    InputMessage::input_message result;
-    switch (read_uint8_t()) {
-        case InputMessage::PLACE_BOMB: {
-            result = read_input_place_bomb_message();
-            break;
-        }
-        case InputMessage::PLACE_BLOCK: {
-            result = read_input_place_block_message();
-            break;
-        }
-        case InputMessage::MOVE: {
-            result = read_input_move_message();
-            break;
-        }
-        default: {
-            throw invalid_argument("bad gui message type");
-        }
+Buffer::buffer_size_t UdpIncomingBuffer::get_input_message_size(message_id_t type) {
+    switch (type) {
+        case InputMessage::PLACE_BOMB:
+            return sizeof(message_id_t) + Codec::fixed_size<InputMessage::PlaceBomb>();
+        case InputMessage::PLACE_BLOCK:
+            return sizeof(message_id_t) + Codec::fixed_size<InputMessage::PlaceBlock>();
+        case InputMessage::MOVE:
+            return sizeof(message_id_t) + Codec::fixed_size<InputMessage::Move>();
+        default:
+            return 0;
     }
-
-    if (read_index != size_) {
-        throw invalid_argument("gui message too long");
-    }
-
-    reset_buffer();
-    return result;
 }
 
-InputMessage::Move UdpIncomingBuffer::read_input_move_message() {
-    auto direction_number = read_uint8_t();
-    return InputMessage::Move{Direction{direction_number}};
-}
+ReadStatus UdpIncomingBuffer::try_read_input_message(InputMessage::input_message &result) {
+    if (size_ == 0 || get_input_message_size(buffer_[0]) != size_) {
+        reset_buffer();
+        return ReadStatus::MALFORMED;
+    }
 
-InputMessage::PlaceBomb UdpIncomingBuffer::read_input_place_bomb_message() {
-    return InputMessage::PlaceBomb{};
-}
+    read_value(result);
 
-InputMessage::PlaceBlock UdpIncomingBuffer::read_input_place_block_message() {
-    return InputMessage::PlaceBlock{};
+    reset_buffer();
+    return ReadStatus::COMPLETE;
 }
 
 UdpIncomingBuffer::UdpIncomingBuffer() : IncomingBuffer() {}
\ No newline at end of file
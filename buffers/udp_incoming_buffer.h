@@ -10,13 +10,13 @@ class UdpIncomingBuffer : public IncomingBuffer {
 public:
     UdpIncomingBuffer();
 
-    InputMessage::input_message read_input_message();
+    // Whole datagram has to be exactly one message, otherwise it's MALFORMED,
+    // result is set only when COMPLETE is returned
+    ReadStatus try_read_input_message(InputMessage::input_message &result);
     void add_packet(std::vector<uint8_t> &data, buffer_size_t size) override;
 
 private:
-    InputMessage::Move read_input_move_message();
-    static InputMessage::PlaceBomb read_input_place_bomb_message();
-    static InputMessage::PlaceBlock read_input_place_block_message();
+    static buffer_size_t get_input_message_size(message_id_t type);
 
     void reset_buffer();
 };
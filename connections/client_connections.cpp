@@ -9,8 +9,9 @@ Client::Client(boost::asio::io_context &io_context, ClientParameters &parameters
                                                                                     server_connection_(),
                                                                                     gameInfo_(parameters.get_player_name()) {
 
-    gui_connection_ = make_shared<GuiConnection>(io_context, parameters.get_gui_address(),
-                                                 parameters.get_port(), *this);
+    gui_connection_ = make_shared<GuiConnection>(io_context, parameters.get_gui_address(), parameters.get_port(),
+                                                 parameters.is_latest_draw_only(),
+                                                 parameters.is_fragmented_draws(), *this);
 
     server_connection_ = make_shared<ServerConnection>(io_context, parameters.get_server_address(), *this);
 
@@ -25,10 +26,18 @@ void Client::handle_input_message(InputMessage::input_message &&msg) {
 }
 
 void Client::handle_server_message(ServerMessage::server_message &&msg) {
-    DrawMessage::draw_message_optional new_msg = gameInfo_.handle_server_message(msg);
+    DrawState *draw = gameInfo_.handle_server_message(msg);
 
-    if (new_msg.has_value()) {
-        gui_connection_->send(new_msg.value());
+    if (draw != nullptr) {
+        gui_connection_->send(*draw);
+    }
+}
+
+void Client::handle_turn(TurnReader &msg) {
+    DrawState *draw = gameInfo_.handle_turn(msg);
+
+    if (draw != nullptr) {
+        gui_connection_->send(*draw);
     }
 }
 
@@ -37,14 +46,22 @@ Client::~Client() {
 
     gui_connection_->close();
     server_connection_->close();
+
+    Logger::print_info("client closed, buffer pool - ", BufferPool::get_stats());
 }
 
-GuiConnection::GuiConnection(boost::asio::io_context &io_context, Address &&gui_address,
-                             uint16_t port, Client &client) : Connection(),
-                                                              client_(client),
-                                                              socket_(io_context, udp::endpoint(udp::v6(), port)),
-                                                              remote_endpoint_(),
-                                                              read_msg_() {
+GuiConnection::GuiConnection(boost::asio::io_context &io_context, Address &&gui_address, uint16_t port,
+                             bool latest_draw_only, bool fragmented_draws, Client &client) : Connection(),
+                                                                                     client_(client),
+                                                                                     latest_draw_only_(latest_draw_only),
+                                                                                     fragmented_draws_(fragmented_draws),
+                                                                                     next_frame_(0),
+                                                                                     pending_draw_(nullptr),
+                                                                                     dropped_draws_(0),
+                                                                                     socket_(io_context, udp::endpoint(udp::v6(), port)),
+                                                                                     remote_endpoint_(),
+                                                                                     buffer_(Buffer::MAX_PACKET_LENGTH),
+                                                                                     read_msg_() {
     Logger::print_debug("creating gui connection");
 
     udp::resolver resolver(io_context);
@@ -58,18 +75,49 @@ GuiConnection::GuiConnection(boost::asio::io_context &io_context, Address &&gui_
 
 void GuiConnection::close() {
     socket_.close();
-    Logger::print_debug("gui connection closed");
+    Logger::print_debug("gui connection closed, dropped draws - ", dropped_draws_);
 }
 
-void GuiConnection::send(DrawMessage::draw_message &msg) {
+void GuiConnection::send(DrawState &draw) {
     bool write_in_progress = !write_msgs_.empty();
-    write_msgs_.emplace_back(msg);
 
-    if (!write_in_progress) {
+    if (latest_draw_only_ && write_in_progress) {
+        if (pending_draw_ != nullptr) {
+            dropped_draws_++;
+        }
+        pending_draw_ = &draw;
+        return;
+    }
+
+    queue_draw(draw);
+
+    if (!write_in_progress && !write_msgs_.empty()) {
         do_write_message();
     }
 }
 
+void GuiConnection::queue_draw(DrawState &draw) {
+    auto encoded_msg = make_shared<OutgoingBuffer>(draw.get_message());
+
+    if (!fragmented_draws_) {
+        if (encoded_msg->size() > Buffer::MAX_PACKET_LENGTH) {
+            Logger::print_error("draw of ", encoded_msg->size(), " bytes doesn't fit in datagram - dropped, "
+                                "use fragmented draws to send it");
+        } else {
+            write_msgs_.emplace_back(move(encoded_msg));
+        }
+        return;
+    }
+    if (encoded_msg->size() > DrawMessage::Fragment::MAX_FRAME_SIZE) {
+        Logger::print_error("draw of ", encoded_msg->size(), " bytes is bigger than a frame - dropped");
+        return;
+    }
+
+    for (auto &fragment: split_into_fragments(*encoded_msg, next_frame_++)) {
+        write_msgs_.emplace_back(move(fragment));
+    }
+}
+
 void GuiConnection::do_read_message() {
     socket_.async_receive_from(
             boost::asio::buffer(&buffer_[0], Buffer::MAX_PACKET_LENGTH),
@@ -79,10 +127,11 @@ void GuiConnection::do_read_message() {
                     Logger::print_debug("read message from gui - ", length, " bytes");
                     read_msg_.add_packet(buffer_, length);
 
-                    try {
-                        client_.handle_input_message(read_msg_.read_input_message());
-                    } catch (exception &e) { // it's udp - ignore incorrect messages
-                        Logger::print_debug("bad message from gui - ", e.what());
+                    InputMessage::input_message msg;
+                    if (read_msg_.try_read_input_message(msg) == ReadStatus::COMPLETE) {
+                        client_.handle_input_message(move(msg));
+                    } else { // it's udp - ignore incorrect messages
+                        Logger::print_debug("bad message from gui");
                     }
                 } else {
                     Logger::print_debug("error in reading from gui");
@@ -95,15 +144,18 @@ void GuiConnection::do_read_message() {
 
 void GuiConnection::do_write_message() {
     socket_.async_send_to(
-            boost::asio::buffer(write_msgs_.front().get_buffer(), write_msgs_.front().size()),
+            boost::asio::buffer(write_msgs_.front()->get_buffer(), write_msgs_.front()->size()),
             remote_endpoint_,
-            [this](boost::system::error_code ec, size_t) {
-                OutgoingBuffer sent_msg = write_msgs_.front();
+            [this](boost::system::error_code ec, size_t length) {
                 write_msgs_.pop_front();
 
                 if (!ec) {
-                    Logger::print_debug("send message to gui - ", sent_msg.size(), " bytes: ", sent_msg);
+                    Logger::print_debug("send message to gui - ", length, " bytes");
 
+                    if (pending_draw_ != nullptr) {
+                        queue_draw(*pending_draw_);
+                        pending_draw_ = nullptr;
+                    }
                     if (!write_msgs_.empty()) {
                         do_write_message();
                     }
@@ -133,24 +185,19 @@ ServerConnection::ServerConnection(boost::asio::io_context &io_context, Address
 }
 
 void ServerConnection::handle_messages_in_bufor() {
-    bool is_sth_to_read_in_buffer = true;
+    ReadStatus status;
 
-    while (is_sth_to_read_in_buffer) {
-        try {
-            client_.handle_server_message(read_msg_.read_server_message());
-        } catch (length_error &e) { // invalid argument should break whole program
-            is_sth_to_read_in_buffer = false;
-        }
+    // turns are applied to the client while they're decoded
+    while ((status = read_msg_.try_visit_server_message(client_)) == ReadStatus::COMPLETE) {}
+
+    // incorrect message should break whole program
+    if (status == ReadStatus::MALFORMED) {
+        throw invalid_argument("bad message from server on " + address_);
     }
 }
 
 void ServerConnection::send(ClientMessage::client_message &msg) {
-    bool write_in_progress = !write_msgs_.empty();
-    write_msgs_.emplace_back(msg);
-
-    if (!write_in_progress) {
-        do_write_message();
-    }
+    queue_message(make_shared<OutgoingBuffer>(msg));
 }
 
 void ServerConnection::handle_connection_error() {
@@ -20,6 +20,7 @@ public:
 
     void handle_input_message(InputMessage::input_message &&msg);
     void handle_server_message(ServerMessage::server_message &&msg);
+    void handle_turn(TurnReader &msg);
 
 private:
     std::shared_ptr<GuiConnection> gui_connection_;
@@ -30,19 +31,31 @@ private:
 // Class for handling connection with gui
 class GuiConnection : public Connection {
 public:
-    GuiConnection(boost::asio::io_context &io_context, Address &&gui_address,
-                  uint16_t port, Client &client);
+    GuiConnection(boost::asio::io_context &io_context, Address &&gui_address, uint16_t port,
+                  bool latest_draw_only, bool fragmented_draws, Client &client);
 
     void close() override;
 
-    void send(DrawMessage::draw_message &msg);
+    // With latest_draw_only, draws given while another one is being sent
+    // replace each other and only the last one is sent after it.
+    // With fragmented_draws, every draw is sent as a numbered frame split
+    // into datagrams, otherwise draws bigger than a datagram are dropped.
+    void send(DrawState &draw);
 
 private:
     Client &client_;
+    bool latest_draw_only_;
+    bool fragmented_draws_;
+    uint32_t next_frame_;
+    // kept up to date by game info, so it's encoded only when it's sent
+    DrawState *pending_draw_;
+    size_t dropped_draws_;
     boost::asio::ip::udp::socket socket_;
     boost::asio::ip::udp::endpoint remote_endpoint_;
+    std::vector<uint8_t> buffer_;
     UdpIncomingBuffer read_msg_;
 
+    void queue_draw(DrawState &draw);
     void do_read_message();
     void do_write_message();
 };
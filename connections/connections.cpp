@@ -3,17 +3,19 @@
 
 using namespace std;
 
-Connection::Connection() : write_msgs_(), buffer_(Buffer::MAX_PACKET_LENGTH) {}
+Connection::Connection() : write_msgs_() {}
 
 void TCPConnection::do_read_message() {
+    span<uint8_t> free_space = read_msg_.get_free_space();
+
     socket_.async_read_some(
-            boost::asio::buffer(&buffer_[0], Buffer::MAX_PACKET_LENGTH),
+            boost::asio::buffer(free_space.data(), free_space.size()),
             [this](boost::system::error_code ec, size_t length) {
                 if (!ec) {
                     Logger::print_debug("read message from ", address_, " - ", length, " bytes");
 
-                    read_msg_.add_packet(buffer_, length);
-                    
+                    read_msg_.commit_packet(length);
+
                     handle_messages_in_bufor();
                     do_read_message();
                 } else {
@@ -27,15 +29,57 @@ void TCPConnection::close() {
     socket_.close();
 }
 
+void TCPConnection::queue_message(const shared_outgoing_buffer &msg) {
+    bool write_in_progress = !write_msgs_.empty();
+    write_msgs_.emplace_back(msg);
+    queued_bytes_ += msg->size();
+
+    if (!write_in_progress) {
+        do_write_message();
+    }
+}
+
+void TCPConnection::drop_queued_messages() {
+    while (write_msgs_.size() > messages_in_flight_) {
+        queued_bytes_ -= write_msgs_.back()->size();
+        write_msgs_.pop_back();
+    }
+}
+
+TCPConnection::StreamPosition TCPConnection::get_queued_end() {
+    return StreamPosition{written_.messages + write_msgs_.size(), written_.bytes + queued_bytes_};
+}
+
 void TCPConnection::do_write_message() {
-    socket_.async_send(
-            boost::asio::buffer(write_msgs_.front().get_buffer(), write_msgs_.front().size()),
-            [this](boost::system::error_code ec, size_t) {
+    vector<boost::asio::const_buffer> buffers;
+    size_t flush_bytes = 0;
+
+    // at least one message is sent, even if it's bigger than the limit
+    for (auto &msg: write_msgs_) {
+        if (!buffers.empty() && (buffers.size() == MAX_FLUSH_MESSAGES || flush_bytes + msg->size() > MAX_FLUSH_BYTES)) {
+            break;
+        }
+
+        buffers.emplace_back(msg->get_buffer(), msg->size());
+        flush_bytes += msg->size();
+    }
+    messages_in_flight_ = buffers.size();
+
+    boost::asio::async_write(
+            socket_,
+            buffers,
+            [this](boost::system::error_code ec, size_t length) {
                 if (!ec) {
-                    Logger::print_debug("send message to ", address_, " - ", write_msgs_.front().size(), 
-                                        " bytes: ", write_msgs_.front());
-                    
-                    write_msgs_.pop_front();
+                    Logger::print_debug("send ", messages_in_flight_, " messages to ", address_, " - ",
+                                        length, " bytes");
+
+                    for (size_t i = 0; i < messages_in_flight_; i++) {
+                        queued_bytes_ -= write_msgs_.front()->size();
+                        written_.bytes += write_msgs_.front()->size();
+                        write_msgs_.pop_front();
+                    }
+                    written_.messages += messages_in_flight_;
+                    messages_in_flight_ = 0;
 
                     if (!write_msgs_.empty()) {
                         do_write_message();
@@ -49,7 +93,10 @@ void TCPConnection::do_write_message() {
 TCPConnection::TCPConnection(boost::asio::ip::tcp::socket socket) : Connection(),
                                                                     socket_(move(socket)),
                                                                     read_msg_(),
-                                                                    address_() {}
+                                                                    address_(),
+                                                                    messages_in_flight_(0),
+                                                                    queued_bytes_(0),
+                                                                    written_{0, 0} {}
 
 string TCPConnection::get_address() {
     return address_;
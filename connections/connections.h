@@ -12,15 +12,24 @@ public:
     virtual void close() = 0;
 
 protected:
-    std::deque<OutgoingBuffer> write_msgs_;
-    std::vector<uint8_t> buffer_;
+    std::deque<shared_outgoing_buffer> write_msgs_;
 
     explicit Connection();
 };
 
-// Class for handling connection with server
+// Class for handling connection with server,
+// queued messages are sent together in one write
 class TCPConnection : public Connection {
 public:
+    static constexpr size_t MAX_FLUSH_BYTES = 1 << 18;
+    static constexpr size_t MAX_FLUSH_MESSAGES = 64;
+
+    // Place in the stream of all messages queued on connection
+    struct StreamPosition {
+        uint64_t messages;
+        uint64_t bytes;
+    };
+
     explicit TCPConnection(boost::asio::ip::tcp::socket socket);
 
     void close() override;
@@ -32,9 +41,19 @@ protected:
     boost::asio::ip::tcp::socket socket_;
     TcpIncomingBuffer read_msg_;
     std::string address_;
+    size_t messages_in_flight_;
+    // all bytes of write_msgs_
+    size_t queued_bytes_;
+    // end of messages, which are already written
+    StreamPosition written_;
 
     void do_read_message();
+    void queue_message(const shared_outgoing_buffer &msg);
     void do_write_message();
+    // only messages, which are being written, are kept
+    void drop_queued_messages();
+    // end of write_msgs_
+    StreamPosition get_queued_end();
 
     virtual void handle_messages_in_bufor() = 0;
     virtual void handle_connection_error() = 0;
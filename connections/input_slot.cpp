@@ -0,0 +1,41 @@
+#include "input_slot.h"
+#include "../logger.h"
+
+using namespace std;
+
+InputSlot::InputSlot() : value_(EMPTY) {}
+
+void InputSlot::publish(const ClientMessage::client_message &msg) {
+    // message type in the high byte and direction of move in the low one
+    auto type = static_cast<uint16_t>(msg.index());
+    uint16_t direction = 0;
+
+    switch (msg.index()) {
+        case ClientMessage::PLACE_BOMB :
+        case ClientMessage::PLACE_BLOCK :
+            break;
+        case ClientMessage::MOVE :
+            direction = get<ClientMessage::Move>(msg).direction;
+            break;
+        default:
+            Logger::print_error("Join can't be published as player's input");
+            return;
+    }
+
+    value_.store(static_cast<uint16_t>(type << 8 | direction), memory_order_release);
+}
+
+ClientMessage::client_message_optional InputSlot::take() {
+    uint16_t value = value_.exchange(EMPTY, memory_order_acquire);
+
+    switch (value >> 8) {
+        case ClientMessage::PLACE_BOMB :
+            return ClientMessage::PlaceBomb{};
+        case ClientMessage::PLACE_BLOCK :
+            return ClientMessage::PlaceBlock{};
+        case ClientMessage::MOVE :
+            return ClientMessage::Move{static_cast<Direction>(value & UINT8_MAX)};
+        default:
+            return nullopt;
+    }
+}
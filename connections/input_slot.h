@@ -0,0 +1,28 @@
+#ifndef ROBOTS_INPUT_SLOT_H
+#define ROBOTS_INPUT_SLOT_H
+
+#include "../structures.h"
+#include <atomic>
+#include <cstdint>
+
+// Latest in-game message of one player, published by the thread reading
+// the connection and taken by the thread playing the room. Messages other
+// than Join fit in 16 bits, so the slot is a single lock-free atomic and
+// neither side ever waits for the other.
+class InputSlot {
+public:
+    InputSlot();
+
+    // Replaces not yet taken message, Join messages aren't accepted
+    void publish(const ClientMessage::client_message &msg);
+    ClientMessage::client_message_optional take();
+
+private:
+    static constexpr uint16_t EMPTY = UINT16_MAX;
+
+    std::atomic<uint16_t> value_;
+
+    static_assert(std::atomic<uint16_t>::is_always_lock_free);
+};
+
+#endif //ROBOTS_INPUT_SLOT_H
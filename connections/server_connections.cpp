@@ -1,81 +1,168 @@
 #include "server_connections.h"
 #include "../logger.h"
+#include <algorithm>
 #include <boost/bind/bind.hpp>
 
 using tcp = boost::asio::ip::tcp;
 using namespace std;
 
-Server::Server(boost::asio::io_context &io_context,
-               ServerParameters &parameters) : acceptor_(io_context, {boost::asio::ip::tcp::v6(), parameters.get_port()}),
-                                               client_connections_(),
-                                               player_connections_(),
-                                               messages_for_new_connection_(),
-                                               hello_message_(parameters),
-                                               gameInfo_(parameters),
-                                               timer_(io_context),
-                                               timer_interval_(parameters.get_turn_duration()) {
-    Logger::print_debug("server created - accepting clients on address ", acceptor_.local_endpoint());
-    do_accept();
-}
-
-Server::~Server() {
-    Logger::print_debug("closing server");
+Room::Room(boost::asio::io_context &io_context, boost::asio::io_context &connections_context,
+           WorkerPool &workers, ServerParameters &parameters, size_t id) : io_context_(io_context),
+                                                                          broadcast_strand_(boost::asio::make_strand(connections_context)),
+                                                                          id_(id),
+                                                                          client_connections_(),
+                                                                          messages_for_new_connection_(),
+                                                                          player_connections_(),
+                                                                          reserving_connections_(),
+                                                                          hello_message_(make_shared<const OutgoingBuffer>(
+                                                                                  ServerMessage::server_message{ServerMessage::Hello(parameters)})),
+                                                                          gameInfo_(parameters, parameters.get_seed() + static_cast<uint32_t>(id), &workers),
+                                                                          timer_(io_context),
+                                                                          timer_interval_(parameters.get_turn_duration()),
+                                                                          players_count_(parameters.get_players_count()),
+                                                                          free_slots_(players_count_),
+                                                                          snapshot_catch_up_(parameters.is_snapshot_catch_up()),
+                                                                          queue_limits_{parameters.get_max_queued_bytes(),
+                                                                                        parameters.get_max_queued_messages(),
+                                                                                        parameters.get_slow_client_policy()} {}
+
+Room::~Room() {
+    Logger::print_debug("closing room ", id_);
 
     for (auto &connection: client_connections_) {
         connection->close();
     }
+}
 
-    acceptor_.close();
+bool Room::try_reserve_slot() {
+    int32_t slots = free_slots_.load(memory_order_relaxed);
+
+    while (slots > 0) {
+        if (free_slots_.compare_exchange_weak(slots, slots - 1, memory_order_relaxed)) {
+            return true;
+        }
+    }
+
+    return false;
 }
 
-void Server::do_accept() {
-    acceptor_.async_accept(
-            [this](boost::system::error_code ec, tcp::socket socket) {
-                if (!ec) {
-                    auto new_client = make_shared<ClientConnection>(move(socket), *this);
-                    ServerMessage::server_message first_msg = hello_message_;
+void Room::add_client(tcp::socket &&socket, bool has_reserved_slot) {
+    auto new_client = make_shared<ClientConnection>(move(socket), *this);
 
-                    new_client->start();
-                    new_client->send(first_msg);
-                    for (auto &msg: messages_for_new_connection_) {
-                        new_client->send(msg);
-                    }
+    // it's posted before client is started, so it's handled before its Join
+    if (has_reserved_slot) {
+        boost::asio::post(io_context_, [this, new_client]() {
+            reserving_connections_.emplace(new_client);
+        });
+    }
 
-                    client_connections_.emplace(new_client);
+    if (snapshot_catch_up_) {
+        send_snapshot(new_client, true);
+    } else {
+        boost::asio::post(broadcast_strand_, [this, new_client]() {
+            start_client(new_client, messages_for_new_connection_.get_chunks());
+        });
+    }
+}
 
-                    Logger::print_debug("client ", new_client->get_address(), " added to connected clients");
-                }
+void Room::resend_snapshot(const shared_ptr<ClientConnection> &client) {
+    send_snapshot(client, false);
+}
 
-                do_accept();
-            });
+const WriteQueueLimits &Room::get_queue_limits() const {
+    return queue_limits_;
 }
 
-void Server::send_message_to_all(ServerMessage::server_message &&msg) {
-    for (auto &connection: client_connections_) {
-        connection->send(msg);
-    }
+void Room::send_snapshot(const shared_ptr<ClientConnection> &client, bool is_new_client) {
+    // snapshot is made between turns, so broadcasts of next turns come to strand after it
+    boost::asio::post(io_context_, [this, client, is_new_client]() {
+        boost::asio::post(broadcast_strand_, [this, client, is_new_client, msgs = gameInfo_.get_catch_up_messages()]() {
+            OutgoingLog snapshot;
+            for (auto &msg: msgs) {
+                snapshot.append(OutgoingBuffer(msg));
+            }
+
+            if (is_new_client) {
+                start_client(client, snapshot.get_chunks());
+            } else {
+                client->send_catch_up(hello_message_, snapshot.get_chunks());
+            }
+        });
+    });
+}
+
+void Room::start_client(const shared_ptr<ClientConnection> &client, const vector<shared_outgoing_buffer> &catch_up_msgs) {
+    client->start();
+    client->send_catch_up(hello_message_, catch_up_msgs);
+
+    client_connections_.emplace(client);
+
+    Logger::print_debug("client ", client->get_address(), " added to connected clients of room ", id_);
 }
 
-void Server::send_and_save_message_to_all(ServerMessage::server_message &&msg) {
-    messages_for_new_connection_.emplace_back(msg);
-    send_message_to_all(move(msg));
+void Room::send_message_to_all(ServerMessage::server_message &&msg, shared_turn_arena arena) {
+    broadcast(PendingMessage{move(arena), move(msg)}, false);
 }
 
-void Server::handle_join_message(ClientMessage::Join &msg, const shared_ptr<ClientConnection> &client) {
+void Room::send_and_save_message_to_all(ServerMessage::server_message &&msg, shared_turn_arena arena) {
+    broadcast(PendingMessage{move(arena), move(msg)}, true);
+}
+
+void Room::clear_saved_messages() {
+    boost::asio::post(broadcast_strand_, [this]() {
+        messages_for_new_connection_.clear();
+    });
+}
+
+void Room::broadcast(PendingMessage &&pending, bool is_saved) {
+    boost::asio::post(broadcast_strand_, [this, pending = move(pending), is_saved]() {
+        // encode message only once, all connections share the same bytes
+        shared_outgoing_buffer encoded_msg = make_shared<OutgoingBuffer>(pending.msg);
+
+        for (auto &connection: client_connections_) {
+            connection->send(encoded_msg);
+        }
+
+        // log keeps only encoded bytes, so it doesn't use the arena
+        if (is_saved && !snapshot_catch_up_) {
+            messages_for_new_connection_.append(*encoded_msg);
+        }
+    });
+}
+
+void Room::handle_join_message(ClientMessage::Join &&msg, const shared_ptr<ClientConnection> &client) {
+    boost::asio::post(io_context_, [this, msg = move(msg), client]() mutable {
+        join_player(msg, client);
+    });
+}
+
+void Room::join_player(ClientMessage::Join &msg, const shared_ptr<ClientConnection> &client) {
     optional<ServerMessage::AcceptedPlayer> possible_msg = gameInfo_.handle_client_join_message(msg, client->get_address());
+    bool has_reserved_slot = reserving_connections_.erase(client) > 0;
 
     if (possible_msg.has_value()) {
         player_connections_.emplace(possible_msg.value().id, client);
+        if (!has_reserved_slot) {
+            free_slots_.fetch_sub(1, memory_order_relaxed);
+        }
         send_and_save_message_to_all(move(possible_msg.value()));
 
         if (gameInfo_.is_enough_players()) {
             // we want to start immediately but make it async
-            timer_.async_wait(boost::bind(&Server::play_game, this));
+            timer_.async_wait(boost::bind(&Room::play_game, this));
         }
+    } else if (has_reserved_slot) {
+        free_slots_.fetch_add(1, memory_order_relaxed);
     }
 }
 
-void Server::handle_turn() {
+void Room::release_reserved_slot(const shared_ptr<ClientConnection> &client) {
+    if (reserving_connections_.erase(client) > 0) {
+        free_slots_.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Room::handle_turn() {
     unordered_map<player_id_t, ClientMessage::client_message> messages_to_handle;
 
     for (auto &player: player_connections_) {
@@ -86,24 +173,33 @@ void Server::handle_turn() {
         }
     }
 
-    send_and_save_message_to_all(gameInfo_.handle_turn(messages_to_handle));
+    auto [turn, arena] = gameInfo_.handle_turn(messages_to_handle);
+    send_and_save_message_to_all(move(turn), move(arena));
 
     if (gameInfo_.is_end_of_game()) {
-        messages_for_new_connection_.clear();
+        clear_saved_messages();
         player_connections_.clear();
 
         send_message_to_all(gameInfo_.end_game());
+        free_slots_.store(players_count_, memory_order_relaxed);
+
+        Logger::print_info("game ended in room ", id_, ", buffer pool - ", BufferPool::get_stats(),
+                           ", slow clients - ", ClientConnection::get_stats());
     } else {
-        timer_.expires_after(timer_interval_);
-        timer_.async_wait(boost::bind(&Server::handle_turn, this));
+        // turns are counted from the previous expiry, so sending doesn't delay them
+        timer_.expires_at(timer_.expiry() + timer_interval_);
+        timer_.async_wait(boost::bind(&Room::handle_turn, this));
     }
 }
 
-void Server::play_game() {
-    messages_for_new_connection_.clear();
+void Room::play_game() {
+    // all slots are taken by players, so reservations don't matter anymore
+    reserving_connections_.clear();
+    free_slots_.store(0, memory_order_relaxed);
+    clear_saved_messages();
     ServerGameInfo::start_game_messages initial_msgs = gameInfo_.start_game();
-    send_and_save_message_to_all(initial_msgs.first);
-    send_and_save_message_to_all(initial_msgs.second);
+    send_and_save_message_to_all(move(initial_msgs.first));
+    send_and_save_message_to_all(move(initial_msgs.second.turn), move(initial_msgs.second.arena));
 
     // clean messages sent before game started
     for (auto &player: player_connections_) {
@@ -111,59 +207,233 @@ void Server::play_game() {
     }
 
     timer_.expires_after(timer_interval_);
-    timer_.async_wait(boost::bind(&Server::handle_turn, this));
+    timer_.async_wait(boost::bind(&Room::handle_turn, this));
 }
 
-void Server::disconnect_client(const shared_ptr<ClientConnection> &client) {
-    client_connections_.erase(client);
+void Room::disconnect_client(const shared_ptr<ClientConnection> &client) {
+    boost::asio::post(io_context_, [this, client]() {
+        release_reserved_slot(client);
+    });
+    boost::asio::post(broadcast_strand_, [this, client]() {
+        client_connections_.erase(client);
+    });
 }
 
+Server::Server(boost::asio::io_context &io_context,
+               ServerParameters &parameters) : acceptor_(io_context, {boost::asio::ip::tcp::v6(), parameters.get_port()}),
+                                               connections_context_(),
+                                               io_contexts_(),
+                                               work_guards_(),
+                                               workers_(max(1u, thread::hardware_concurrency()) - 1),
+                                               rooms_(),
+                                               threads_(),
+                                               next_room_(0) {
+    size_t rooms_count = parameters.get_rooms_count();
+    if (rooms_count == 0) {
+        throw invalid_argument("rooms count has to be positive");
+    }
+    size_t threads_count = clamp<size_t>(parameters.get_threads_count(), 1, rooms_count);
+    size_t io_threads_count = max<size_t>(parameters.get_io_threads_count(), 1);
+
+    for (size_t i = 1; i < threads_count; i++) {
+        io_contexts_.emplace_back(make_unique<boost::asio::io_context>());
+        work_guards_.emplace_back(boost::asio::make_work_guard(*io_contexts_.back()));
+    }
+
+    // room i is played by thread i % threads_count, thread 0 is the one running given io_context
+    for (size_t i = 0; i < rooms_count; i++) {
+        size_t thread = i % threads_count;
+        boost::asio::io_context &room_context = (thread == 0) ? io_context : *io_contexts_[thread - 1];
+
+        rooms_.emplace_back(make_unique<Room>(room_context, connections_context_, workers_, parameters, i));
+    }
+
+    work_guards_.emplace_back(boost::asio::make_work_guard(connections_context_));
+    for (size_t i = 0; i < io_threads_count; i++) {
+        threads_.emplace_back(&Server::run_thread, this, ref(connections_context_));
+    }
+    for (auto &context: io_contexts_) {
+        threads_.emplace_back(&Server::run_thread, this, ref(*context));
+    }
+
+    Logger::print_debug("server created - accepting clients on address ", acceptor_.local_endpoint(),
+                        ", rooms: ", rooms_count, ", threads: ", threads_count, ", io threads: ", io_threads_count,
+                        ", explosion workers: ", workers_.get_parallelism() - 1);
+    do_accept();
+}
+
+Server::~Server() {
+    Logger::print_debug("closing server");
+
+    acceptor_.close();
+
+    connections_context_.stop();
+    for (auto &context: io_contexts_) {
+        context->stop();
+    }
+    for (auto &thread: threads_) {
+        thread.join();
+    }
+
+    rooms_.clear();
+
+    Logger::print_info("server closed, buffer pool - ", BufferPool::get_stats(),
+                       ", slow clients - ", ClientConnection::get_stats());
+}
+
+void Server::run_thread(boost::asio::io_context &io_context) {
+    // error in one connection shouldn't stop other rooms
+    for (;;) {
+        try {
+            io_context.run();
+            return;
+        } catch (exception &e) {
+            Logger::print_error(e.what());
+        }
+    }
+}
+
+void Server::do_accept() {
+    // every connection gets its own strand in the pool of connection threads
+    acceptor_.async_accept(
+            boost::asio::make_strand(connections_context_),
+            [this](boost::system::error_code ec, tcp::socket socket) {
+                if (!ec) {
+                    add_client(move(socket));
+                }
+
+                do_accept();
+            });
+}
+
+void Server::add_client(tcp::socket &&socket) {
+    for (auto &room: rooms_) {
+        if (room->try_reserve_slot()) {
+            room->add_client(move(socket), true);
+            return;
+        }
+    }
+
+    rooms_[next_room_]->add_client(move(socket), false);
+    next_room_ = (next_room_ + 1) % rooms_.size();
+}
+
+atomic<uint64_t> ClientConnection::disconnects_{0};
+atomic<uint64_t> ClientConnection::snapshots_{0};
+
 ClientConnection::ClientConnection(boost::asio::ip::tcp::socket socket,
-                                   Server &server) : TCPConnection(move(socket)),
-                                                     server_(server),
-                                                     last_message_() {
+                                   Room &room) : TCPConnection(move(socket)),
+                                                 room_(room),
+                                                 latest_input_(),
+                                                 limits_(room.get_queue_limits()),
+                                                 waiting_for_snapshot_(false),
+                                                 is_dropped_(false),
+                                                 catch_up_end_{0, 0} {
     set_proper_address();
 }
 
 void ClientConnection::start() {
-    do_read_message();
+    boost::asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+        self->do_read_message();
+    });
+}
+
+void ClientConnection::send(const shared_outgoing_buffer &msg) {
+    boost::asio::post(socket_.get_executor(), [self = shared_from_this(), msg]() {
+        self->queue_limited_message(msg);
+    });
+}
+
+void ClientConnection::send_catch_up(const shared_outgoing_buffer &hello, const vector<shared_outgoing_buffer> &msgs) {
+    boost::asio::post(socket_.get_executor(), [self = shared_from_this(), hello, msgs]() {
+        if (self->is_dropped_) {
+            return;
+        }
+
+        // messages dropped while waiting are older than the snapshot
+        self->waiting_for_snapshot_ = false;
+        self->queue_message(hello);
+        for (auto &msg: msgs) {
+            self->queue_message(msg);
+        }
+        self->catch_up_end_ = self->get_queued_end();
+    });
+}
+
+ClientConnection::Stats ClientConnection::get_stats() {
+    return Stats{disconnects_.load(memory_order_relaxed), snapshots_.load(memory_order_relaxed)};
+}
+
+ostream &operator<<(ostream &os, const ClientConnection::Stats &stats) {
+    return os << "disconnects: " << stats.disconnects << ", snapshots: " << stats.snapshots;
 }
 
-void ClientConnection::send(ServerMessage::server_message &msg) {
-    bool write_in_progress = !write_msgs_.empty();
-    write_msgs_.emplace_back(msg);
+void ClientConnection::queue_limited_message(const shared_outgoing_buffer &msg) {
+    if (is_dropped_ || waiting_for_snapshot_) {
+        return;
+    }
 
-    if (!write_in_progress) {
-        do_write_message();
+    StreamPosition limited = get_limited_queue();
+    if (limited.messages >= limits_.max_messages || limited.bytes + msg->size() > limits_.max_bytes) {
+        handle_slow_client();
+    } else {
+        queue_message(msg);
     }
 }
 
-ClientMessage::client_message_optional ClientConnection::get_latest_message() {
-    ClientMessage::client_message_optional result = last_message_;
-    last_message_ = nullopt;
+TCPConnection::StreamPosition ClientConnection::get_limited_queue() {
+    StreamPosition end = get_queued_end();
+    // messages before the end of catch-up, which aren't written yet, are skipped
+    uint64_t first_message = min(end.messages, max(catch_up_end_.messages, written_.messages));
+    uint64_t first_byte = min(end.bytes, max(catch_up_end_.bytes, written_.bytes));
 
-    return result;
+    return StreamPosition{end.messages - first_message, end.bytes - first_byte};
 }
 
-void ClientConnection::handle_messages_in_bufor() {
-    bool is_sth_to_read_in_buffer = true;
-    while (is_sth_to_read_in_buffer) {
-        try {
-            auto msg = read_msg_.read_client_message();
+void ClientConnection::handle_slow_client() {
+    if (limits_.policy == SlowClientPolicy::DISCONNECT) {
+        disconnects_.fetch_add(1, memory_order_relaxed);
+        Logger::print_debug("client ", address_, " is too slow - closing connection");
 
-            if (msg.index() == ClientMessage::JOIN) {
-                server_.handle_join_message(get<ClientMessage::Join>(msg), shared_from_this());
-            } else {
-                last_message_ = msg;
-            }
-        } catch (length_error &e) { // invalid argument should break whole program
-            is_sth_to_read_in_buffer = false;
-        }
+        // next read on closed socket fails and client is disconnected
+        is_dropped_ = true;
+        drop_queued_messages();
+        close();
+    } else {
+        snapshots_.fetch_add(1, memory_order_relaxed);
+        Logger::print_debug("client ", address_, " is too slow - sending snapshot instead of ",
+                            write_msgs_.size(), " messages");
+
+        waiting_for_snapshot_ = true;
+        drop_queued_messages();
+        room_.resend_snapshot(shared_from_this());
     }
 }
 
+ClientMessage::client_message_optional ClientConnection::get_latest_message() {
+    return latest_input_.take();
+}
+
+void ClientConnection::handle_messages_in_bufor() {
+    ClientMessage::client_message msg;
+    ReadStatus status;
+
+    while ((status = read_msg_.try_read_client_message(msg)) == ReadStatus::COMPLETE) {
+        if (msg.index() == ClientMessage::JOIN) {
+            room_.handle_join_message(move(get<ClientMessage::Join>(msg)), shared_from_this());
+        } else {
+            latest_input_.publish(msg);
+        }
+    }
+
+    // next read on closed socket fails and client is disconnected
+    if (status == ReadStatus::MALFORMED) {
+        Logger::print_debug("bad message from ", address_, " - closing connection");
+        close();
+    }
+}
 
 void ClientConnection::handle_connection_error() {
-    server_.disconnect_client(shared_from_this());
+    room_.disconnect_client(shared_from_this());
 }
 
@@ -3,59 +3,177 @@
 
 #include "../parameters.h"
 #include "../structures.h"
+#include "../buffers/outgoing_log.h"
 #include "../game_managers/server_game_info.h"
 #include "connections.h"
+#include "input_slot.h"
+#include <atomic>
 #include <boost/asio.hpp>
+#include <memory>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 class ClientConnection;
 
-class Server {
+// Limits of messages waiting for sending to one client
+struct WriteQueueLimits {
+    size_t max_bytes;
+    size_t max_messages;
+    SlowClientPolicy policy;
+};
+
+// One game with its own state, timer and messages for new connections,
+// which are all messages of the game or its snapshot made when they come.
+// Game is played on room's io_context, so rooms on different io_contexts
+// are played in parallel without locks. Connections are handled by other
+// threads, they pass players' input through InputSlot and everything else
+// by posting to room's io_context. Messages are encoded and sent to all
+// connections on broadcast strand, so the next turn is computed meanwhile.
+class Room {
 public:
-    Server(boost::asio::io_context &io_context, ServerParameters &parameters);
+    Room(boost::asio::io_context &io_context, boost::asio::io_context &connections_context,
+         WorkerPool &workers, ServerParameters &parameters, size_t id);
 
-    virtual ~Server();
+    virtual ~Room();
 
-    void handle_join_message(ClientMessage::Join &msg, const std::shared_ptr<ClientConnection> &client);
+    // Takes a lobby slot for a new connection, which is probably going to
+    // send Join, so connections accepted at once are spread over rooms.
+    // Slot is given back, when connection is closed or its Join is rejected.
+    bool try_reserve_slot();
 
+    // Functions below can be called from any thread
+    void add_client(boost::asio::ip::tcp::socket &&socket, bool has_reserved_slot);
+    void handle_join_message(ClientMessage::Join &&msg, const std::shared_ptr<ClientConnection> &client);
     void disconnect_client(const std::shared_ptr<ClientConnection> &client);
+    // Client gets hello and the snapshot of game again
+    void resend_snapshot(const std::shared_ptr<ClientConnection> &client);
+
+    const WriteQueueLimits &get_queue_limits() const;
+
+protected:
+    // message with memory of its events
+    struct PendingMessage {
+        shared_turn_arena arena;
+        ServerMessage::server_message msg;
+    };
+
+    // Every message of room is sent by this function on room's io_context
+    virtual void broadcast(PendingMessage &&pending, bool is_saved);
 
 private:
-    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::io_context &io_context_;
+    boost::asio::strand<boost::asio::io_context::executor_type> broadcast_strand_;
+    size_t id_;
+    // used only on broadcast strand
     std::unordered_set<std::shared_ptr<ClientConnection>> client_connections_;
+    // used only on broadcast strand, messages are encoded when they're broadcast
+    OutgoingLog messages_for_new_connection_;
     std::unordered_map<player_id_t, std::shared_ptr<ClientConnection>> player_connections_;
-    std::vector<ServerMessage::server_message> messages_for_new_connection_;
-    ServerMessage::Hello hello_message_;
+    // connections with reserved slot, which haven't joined yet
+    std::unordered_set<std::shared_ptr<ClientConnection>> reserving_connections_;
+    shared_outgoing_buffer hello_message_;
     ServerGameInfo gameInfo_;
     boost::asio::steady_timer timer_;
     boost::asio::chrono::milliseconds timer_interval_;
-
-    void do_accept();
-
-    void send_message_to_all(ServerMessage::server_message &&msg);
-    void send_and_save_message_to_all(ServerMessage::server_message &&msg);
+    uint8_t players_count_;
+    // lobby slots neither taken by players nor reserved by connections
+    std::atomic<int32_t> free_slots_;
+    bool snapshot_catch_up_;
+    WriteQueueLimits queue_limits_;
+
+    void start_client(const std::shared_ptr<ClientConnection> &client,
+                      const std::vector<shared_outgoing_buffer> &catch_up_msgs);
+    void join_player(ClientMessage::Join &msg, const std::shared_ptr<ClientConnection> &client);
+    void release_reserved_slot(const std::shared_ptr<ClientConnection> &client);
+    void send_snapshot(const std::shared_ptr<ClientConnection> &client, bool is_new_client);
+
+    // events of message have to be allocated in given arena or in default memory
+    void send_message_to_all(ServerMessage::server_message &&msg, shared_turn_arena arena = nullptr);
+    void send_and_save_message_to_all(ServerMessage::server_message &&msg, shared_turn_arena arena = nullptr);
+    void clear_saved_messages();
 
     void play_game();
     void handle_turn();
 };
 
+// Accepts clients and sends them to rooms waiting for players.
+// Rooms are spread over io_contexts, each run by its own thread, and all
+// connections are handled by a separate pool of threads, every connection
+// on its own strand.
+class Server {
+public:
+    Server(boost::asio::io_context &io_context, ServerParameters &parameters);
+
+    virtual ~Server();
+
+private:
+    using work_guard = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::io_context connections_context_;
+    // io_contexts of rooms other than the one given in constructor
+    std::vector<std::unique_ptr<boost::asio::io_context>> io_contexts_;
+    std::vector<work_guard> work_guards_;
+    // shared by all rooms, so turns of many rooms don't start more threads than cores
+    WorkerPool workers_;
+    std::vector<std::unique_ptr<Room>> rooms_;
+    std::vector<std::thread> threads_;
+    size_t next_room_;
+
+    void run_thread(boost::asio::io_context &io_context);
+    void do_accept();
+
+    // Client gets a reserved slot in the first room with a free one, when
+    // there's none, client is sent to watch rooms in turns
+    void add_client(boost::asio::ip::tcp::socket &&socket);
+};
+
+// Socket of connection has to use a strand, all its work is done there.
+// Broadcast messages are queued only up to limits of the room, client
+// exceeding them is disconnected or gets a snapshot instead of its backlog.
 class ClientConnection :
         public TCPConnection,
         public std::enable_shared_from_this<ClientConnection> {
 public:
-    ClientConnection(boost::asio::ip::tcp::socket socket, Server &server);
+    struct Stats {
+        uint64_t disconnects;
+        uint64_t snapshots;
+
+        friend std::ostream &operator<<(std::ostream &os, const Stats &stats);
+    };
+
+    ClientConnection(boost::asio::ip::tcp::socket socket, Room &room);
 
     void start();
 
-    void send(ServerMessage::server_message &msg);
+    // Can be called from any thread
+    void send(const shared_outgoing_buffer &msg);
+    // Messages, which bring client to the current state, they aren't limited
+    void send_catch_up(const shared_outgoing_buffer &hello, const std::vector<shared_outgoing_buffer> &msgs);
 
+    // Can be called from any thread
     ClientMessage::client_message_optional get_latest_message();
 
+    static Stats get_stats();
+
 private:
-    Server &server_;
-    ClientMessage::client_message_optional last_message_;
+    static std::atomic<uint64_t> disconnects_;
+    static std::atomic<uint64_t> snapshots_;
+
+    Room &room_;
+    InputSlot latest_input_;
+    WriteQueueLimits limits_;
+    bool waiting_for_snapshot_;
+    bool is_dropped_;
+    // end of the last catch-up, only messages queued after it are limited
+    StreamPosition catch_up_end_;
+
+    void queue_limited_message(const shared_outgoing_buffer &msg);
+    // messages and bytes in write_msgs_, which are counted in limits_
+    StreamPosition get_limited_queue();
+    void handle_slow_client();
 
     void handle_messages_in_bufor() override;
     void handle_connection_error() override;
@@ -0,0 +1,145 @@
+#include "block_grid.h"
+
+using namespace std;
+
+BlockGrid::BlockGrid() : BlockGrid(0, 0) {}
+
+BlockGrid::BlockGrid(board_coord_t size_x, board_coord_t size_y) : size_x_(), size_y_(), blocks_count_(0),
+                                                                   rows_(), columns_() {
+    reset(size_x, size_y);
+}
+
+void BlockGrid::reset(board_coord_t size_x, board_coord_t size_y) {
+    size_x_ = size_x;
+    size_y_ = size_y;
+    blocks_count_ = 0;
+
+    size_t cells = static_cast<size_t>(size_x) * size_y;
+    rows_.assign((cells + WORD_BITS - 1) / WORD_BITS, 0);
+    columns_.assign(rows_.size(), 0);
+}
+
+void BlockGrid::clear() {
+    blocks_count_ = 0;
+    fill(rows_.begin(), rows_.end(), 0);
+    fill(columns_.begin(), columns_.end(), 0);
+}
+
+bool BlockGrid::contains(const Position &position) const {
+    return is_on_board(position) && test_bit(rows_, get_row_index(position));
+}
+
+bool BlockGrid::insert(const Position &position) {
+    if (!is_on_board(position) || contains(position)) {
+        return false;
+    }
+
+    set_bit(rows_, get_row_index(position), true);
+    set_bit(columns_, get_column_index(position), true);
+    blocks_count_++;
+
+    return true;
+}
+
+void BlockGrid::erase(const Position &position) {
+    if (!contains(position)) {
+        return;
+    }
+
+    set_bit(rows_, get_row_index(position), false);
+    set_bit(columns_, get_column_index(position), false);
+    blocks_count_--;
+}
+
+size_t BlockGrid::size() const {
+    return blocks_count_;
+}
+
+uint32_t BlockGrid::get_distance_to_block(const Position &position, Direction direction, uint32_t max_distance) const {
+    switch (direction) {
+        case Direction::UP :
+            return find_forward(columns_, get_column_index(position), max_distance);
+        case Direction::RIGHT :
+            return find_forward(rows_, get_row_index(position), max_distance);
+        case Direction::DOWN :
+            return find_backward(columns_, get_column_index(position), max_distance);
+        default:
+            return find_backward(rows_, get_row_index(position), max_distance);
+    }
+}
+
+bool BlockGrid::is_on_board(const Position &position) const {
+    return position.x < size_x_ && position.y < size_y_;
+}
+
+size_t BlockGrid::get_row_index(const Position &position) const {
+    return static_cast<size_t>(position.y) * size_x_ + position.x;
+}
+
+size_t BlockGrid::get_column_index(const Position &position) const {
+    return static_cast<size_t>(position.x) * size_y_ + position.y;
+}
+
+bool BlockGrid::test_bit(const vector<uint64_t> &bits, size_t index) {
+    return (bits[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+}
+
+void BlockGrid::set_bit(vector<uint64_t> &bits, size_t index, bool value) {
+    uint64_t mask = uint64_t{1} << (index % WORD_BITS);
+
+    if (value) {
+        bits[index / WORD_BITS] |= mask;
+    } else {
+        bits[index / WORD_BITS] &= ~mask;
+    }
+}
+
+uint32_t BlockGrid::find_forward(const vector<uint64_t> &bits, size_t start, uint32_t max_distance) {
+    size_t begin = start + 1;
+    size_t end = begin + max_distance;
+
+    while (begin < end) {
+        size_t offset = begin % WORD_BITS;
+        size_t available = min(WORD_BITS - offset, end - begin);
+        uint64_t word = bits[begin / WORD_BITS] >> offset;
+
+        if (available < WORD_BITS) {
+            word &= (uint64_t{1} << available) - 1;
+        }
+        if (word != 0) {
+            return static_cast<uint32_t>(begin + static_cast<size_t>(countr_zero(word)) - start);
+        }
+
+        begin += available;
+    }
+
+    return max_distance + 1;
+}
+
+uint32_t BlockGrid::find_backward(const vector<uint64_t> &bits, size_t start, uint32_t max_distance) {
+    size_t begin = start - max_distance;
+    size_t end = start;
+
+    while (begin < end) {
+        size_t last = end - 1;
+        size_t offset = last % WORD_BITS;
+        size_t word_begin = last - offset;
+        uint64_t word = bits[last / WORD_BITS];
+
+        // only bits from begin to last are looked at
+        if (offset < WORD_BITS - 1) {
+            word &= (uint64_t{2} << offset) - 1;
+        }
+        if (word_begin < begin) {
+            word &= ~((uint64_t{1} << (begin - word_begin)) - 1);
+        }
+        if (word != 0) {
+            size_t found = word_begin + WORD_BITS - 1 - static_cast<size_t>(countl_zero(word));
+            return static_cast<uint32_t>(start - found);
+        }
+
+        end = word_begin;
+    }
+
+    return max_distance + 1;
+}
@@ -0,0 +1,66 @@
+#ifndef ROBOTS_BLOCK_GRID_H
+#define ROBOTS_BLOCK_GRID_H
+
+#include "../structures.h"
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+// Set of blocks stored as one bit per cell of the board, row by row and
+// column by column, so the first block in any direction is found by bit
+// scans over 64 cells at a time. Positions outside of the board are never
+// in the grid.
+class BlockGrid {
+public:
+    BlockGrid();
+    BlockGrid(board_coord_t size_x, board_coord_t size_y);
+
+    // Removes all blocks and sets new size of the board
+    void reset(board_coord_t size_x, board_coord_t size_y);
+    void clear();
+
+    bool contains(const Position &position) const;
+    // returns false when there was already block on position
+    bool insert(const Position &position);
+    void erase(const Position &position);
+
+    size_t size() const;
+
+    // Distance from position to the first block in direction, at most
+    // max_distance cells away, max_distance + 1 when there's no such block.
+    // Cells up to max_distance away have to be on the board.
+    uint32_t get_distance_to_block(const Position &position, Direction direction, uint32_t max_distance) const;
+
+    // Calls f for every block, ordered by y and then by x
+    template<typename F>
+    void for_each(F f) const {
+        for (size_t word = 0; word < rows_.size(); word++) {
+            for (uint64_t bits = rows_[word]; bits != 0; bits &= bits - 1) {
+                size_t index = word * WORD_BITS + static_cast<size_t>(std::countr_zero(bits));
+                f(Position{static_cast<board_coord_t>(index % size_x_),
+                           static_cast<board_coord_t>(index / size_x_)});
+            }
+        }
+    }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+
+    board_coord_t size_x_;
+    board_coord_t size_y_;
+    size_t blocks_count_;
+    std::vector<uint64_t> rows_;
+    std::vector<uint64_t> columns_;
+
+    bool is_on_board(const Position &position) const;
+    size_t get_row_index(const Position &position) const;
+    size_t get_column_index(const Position &position) const;
+
+    static bool test_bit(const std::vector<uint64_t> &bits, size_t index);
+    static void set_bit(std::vector<uint64_t> &bits, size_t index, bool value);
+    // distances to the first bit set after or before start
+    static uint32_t find_forward(const std::vector<uint64_t> &bits, size_t start, uint32_t max_distance);
+    static uint32_t find_backward(const std::vector<uint64_t> &bits, size_t start, uint32_t max_distance);
+};
+
+#endif //ROBOTS_BLOCK_GRID_H
@@ -0,0 +1,23 @@
+#include "bomb_wheel.h"
+
+using namespace std;
+
+// explosion turns of placed bombs differ by at most bomb_timer
+BombWheel::BombWheel(uint16_t bomb_timer) : bomb_timer_(bomb_timer),
+                                            bombs_(),
+                                            slots_(static_cast<size_t>(bomb_timer) + 1) {}
+
+void BombWheel::clear() {
+    bombs_.clear();
+
+    for (auto &slot: slots_) {
+        slot.clear();
+    }
+}
+
+void BombWheel::place(bomb_id_t id, const Position &position, uint16_t turn) {
+    auto explosion_turn = static_cast<uint16_t>(turn + bomb_timer_);
+
+    bombs_.insert_or_assign(id, PlacedBomb{position, explosion_turn});
+    slots_[explosion_turn % slots_.size()].emplace_back(id);
+}
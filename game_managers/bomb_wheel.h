@@ -0,0 +1,58 @@
+#ifndef ROBOTS_BOMB_WHEEL_H
+#define ROBOTS_BOMB_WHEEL_H
+
+#include "../structures.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// Bombs of server stored with the turn of their explosion. Ids of bombs are
+// also kept in a timing wheel with slot for every turn of bomb timer, so
+// finding bombs exploding in a turn doesn't look at other bombs.
+class BombWheel {
+public:
+    explicit BombWheel(uint16_t bomb_timer);
+
+    void clear();
+
+    // Bomb explodes bomb_timer turns after turn
+    void place(bomb_id_t id, const Position &position, uint16_t turn);
+
+    // Calls f(id, position) for bombs exploding in turn, in order of placing,
+    // and removes them. Has to be called for every turn, if bombs should explode.
+    template<typename F>
+    void explode(uint16_t turn, F f) {
+        std::vector<bomb_id_t> &slot = slots_[turn % slots_.size()];
+
+        for (bomb_id_t id: slot) {
+            auto bomb = bombs_.find(id);
+            if (bomb != bombs_.end() && bomb->second.explosion_turn == turn) {
+                Position position = bomb->second.position;
+                bombs_.erase(bomb);
+                f(id, position);
+            }
+        }
+
+        slot.clear();
+    }
+
+    // Calls f(id, position, turn of placing) for every bomb, ordered by id
+    template<typename F>
+    void for_each_placed(F f) const {
+        for (auto &[id, bomb]: bombs_) {
+            f(id, bomb.position, static_cast<uint16_t>(bomb.explosion_turn - bomb_timer_));
+        }
+    }
+
+private:
+    struct PlacedBomb {
+        Position position;
+        uint16_t explosion_turn;
+    };
+
+    uint16_t bomb_timer_;
+    std::map<bomb_id_t, PlacedBomb> bombs_;
+    std::vector<std::vector<bomb_id_t>> slots_;
+};
+
+#endif //ROBOTS_BOMB_WHEEL_H
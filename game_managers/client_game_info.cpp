@@ -8,9 +8,9 @@ ClientGameInfo::ClientGameInfo(string player_name) : GameInfo(),
     this->state = GameState::NotConnected;
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_server_message(ServerMessage::server_message &msg) {
+DrawState *ClientGameInfo::handle_server_message(ServerMessage::server_message &msg) {
     if (state == NotConnected && msg.index() != ServerMessage::HELLO) {
-        return nullopt;
+        return nullptr;
     }
 
     switch (msg.index()) {
@@ -26,7 +26,7 @@ DrawMessage::draw_message_optional ClientGameInfo::handle_server_message(ServerM
             return handle_game_ended();
         default:
             Logger::print_error("Internal problem with variant");
-            return nullopt;
+            return nullptr;
     }
 }
 
@@ -50,18 +50,24 @@ ClientMessage::client_message_optional ClientGameInfo::handle_GUI_message(InputM
     }
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::generate_draw_message() {
+DrawState *ClientGameInfo::generate_draw_message() {
     if (state == GameState::NotConnected) {
-        return nullopt;
+        return nullptr;
     } else if (state == GameState::Lobby) {
-        return DrawMessage::Lobby(basic_info, players_count, explosion_radius, bomb_timer, players);
-    } else {
-        return DrawMessage::Game(basic_info, turn, players, bombs, blocks, explosions);
+        draw_state_.set_lobby(DrawMessage::Lobby(basic_info, players_count, explosion_radius, bomb_timer, players));
     }
+
+    // game is kept up to date by events
+    return &draw_state_;
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_hello(ServerMessage::Hello &msg) {
+DrawState *ClientGameInfo::handle_hello(ServerMessage::Hello &msg) {
+    // server sends hello again with a snapshot, when client was too slow
+    clean_after_game();
+    explosions.clear();
+
     basic_info = GameBasicInfo{msg.server_name, msg.size_x, msg.size_y, msg.game_length};
+    blocks.reset(msg.size_x, msg.size_y);
     players_count = msg.players_count;
     explosion_radius = msg.explosion_radius;
     bomb_timer = msg.bomb_timer;
@@ -71,54 +77,73 @@ DrawMessage::draw_message_optional ClientGameInfo::handle_hello(ServerMessage::H
     return generate_draw_message();
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_accepted_player(ServerMessage::AcceptedPlayer &msg) {
+DrawState *ClientGameInfo::handle_accepted_player(ServerMessage::AcceptedPlayer &msg) {
     players.emplace(msg.id, PlayerInfo{msg.id, msg.player, Position{0, 0}, 0});
 
     return generate_draw_message();
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_game_started(ServerMessage::GameStarted &msg) {
+DrawState *ClientGameInfo::handle_game_started(ServerMessage::GameStarted &msg) {
     state = GameState::Game;
 
     for (auto &it: msg.players) {
         players.emplace(it.first, PlayerInfo{it.first, it.second, Position{0, 0}, 0});
     }
+    draw_state_.start_game(basic_info, players);
 
-    return nullopt;
+    return nullptr;
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_turn(ServerMessage::Turn &msg) {
-    if (state != GameState::Game) {
-        return nullopt;
+DrawState *ClientGameInfo::handle_turn(ServerMessage::Turn &msg) {
+    if (!start_turn(msg.turn)) {
+        return nullptr;
     }
 
-    if (turn < msg.turn) {
-        uint16_t diff = msg.turn - turn;
-        for (auto &it: bombs) {
-            it.second.timer -= diff;
-        }
+    for (auto &it: msg.events) {
+        handle_event(it);
     }
 
-    turn = msg.turn;
+    return finish_turn();
+}
+
+DrawState *ClientGameInfo::handle_turn(TurnReader &msg) {
+    if (!start_turn(msg.get_turn())) {
+        return nullptr;
+    }
+
+    msg.visit_events(*this);
+
+    return finish_turn();
+}
+
+bool ClientGameInfo::start_turn(uint16_t new_turn) {
+    if (state != GameState::Game) {
+        return false;
+    }
+
+    turn = new_turn;
     destroyed_robots.clear();
     explosions.clear();
+    draw_state_.start_turn(new_turn);
 
-    for (auto &it: msg.events) {
-        handle_event(it);
-    }
+    return true;
+}
 
+DrawState *ClientGameInfo::finish_turn() {
     for (auto id: destroyed_robots) {
-        players[id].score++;
+        draw_state_.set_score(id, ++players[id].score);
     }
 
     for (auto &it: explosions) {
         blocks.erase(it);
+        draw_state_.erase_block(it);
+        draw_state_.add_explosion(it);
     }
 
     return generate_draw_message();
 }
 
-DrawMessage::draw_message_optional ClientGameInfo::handle_game_ended() {
+DrawState *ClientGameInfo::handle_game_ended() {
     clean_after_game();
     return generate_draw_message();
 }
@@ -128,9 +153,17 @@ void ClientGameInfo::handle_event(Event::event_message &event) {
         case Event::BOMB_PLACED :
             handle_bomb_placed(get<Event::BombPlacedEvent>(event));
             return;
-        case Event::BOMB_EXPLODED :
-            handle_bomb_exploded(get<Event::BombExplodedEvent>(event));
+        case Event::BOMB_EXPLODED : {
+            auto &bomb_exploded = get<Event::BombExplodedEvent>(event);
+            handle_bomb_exploded(bomb_exploded.id);
+            for (auto id: bomb_exploded.robots_destroyed) {
+                handle_robot_destroyed(id);
+            }
+            for (auto &block: bomb_exploded.blocks_destroyed) {
+                handle_block_destroyed(block);
+            }
             return;
+        }
         case Event::PLAYER_MOVED :
             handle_player_moved(get<Event::PlayerMovedEvent>(event));
             return;
@@ -144,38 +177,42 @@ void ClientGameInfo::handle_event(Event::event_message &event) {
 }
 
 void ClientGameInfo::handle_bomb_placed(Event::BombPlacedEvent &event) {
-    bombs.emplace(event.id, Bomb{event.position, bomb_timer});
+    draw_state_.place_bomb(event.id, event.position, bomb_timer);
 }
 
-void ClientGameInfo::handle_bomb_exploded(Event::BombExplodedEvent &event) {
-    Position bomb_position = bombs[event.id].position;
-    make_bomb_explosion(bomb_position);
-    bombs.erase(event.id);
-
-    for (auto &id: event.robots_destroyed) {
-        destroyed_robots.insert(id);
+void ClientGameInfo::handle_bomb_exploded(bomb_id_t id) {
+    const Position *bomb_position = draw_state_.find_bomb(id);
+    if (bomb_position != nullptr) {
+        Position position = *bomb_position;
+        make_bomb_explosion(position, [this](Position &cell, bool is_block) {
+            handle_explosion_for_position(cell, is_block);
+        });
+        draw_state_.erase_bomb(id);
     }
+}
 
-    for (auto &block: event.blocks_destroyed) {
-        explosions.insert(block);
-    }
+void ClientGameInfo::handle_robot_destroyed(player_id_t id) {
+    destroyed_robots.insert(id);
+}
+
+void ClientGameInfo::handle_block_destroyed(Position &block) {
+    explosions.insert(block);
 }
 
 void ClientGameInfo::handle_player_moved(Event::PlayerMovedEvent &event) {
-    players[event.id].position = event.position;
+    set_player_position(players[event.id], event.position);
+    draw_state_.move_player(event.id, event.position);
 }
 
 void ClientGameInfo::handle_block_placed(Event::BlockPlacedEvent &event) {
-    blocks.emplace(event.position);
+    if (blocks.insert(event.position)) {
+        draw_state_.place_block(event.position);
+    }
 }
 
 
-void ClientGameInfo::handle_explosion_for_position(int32_t x, int32_t y, bool &is_direction_ok) {
-    Position possible_position = {static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
-
-    if (is_direction_ok && is_position_on_board(x, y) && !is_block_on_position(possible_position)) {
-        explosions.insert(possible_position);
-    } else {
-        is_direction_ok = false;
+void ClientGameInfo::handle_explosion_for_position(Position &position, bool is_block) {
+    if (!is_block) {
+        explosions.insert(position);
     }
 }
\ No newline at end of file
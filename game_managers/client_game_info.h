@@ -2,6 +2,8 @@
 #define ROBOTS_CLIENT_GAME_INFO_H
 
 #include "../structures.h"
+#include "../buffers/turn_reader.h"
+#include "draw_state.h"
 #include "game_info.h"
 #include <string>
 #include <unordered_set>
@@ -10,28 +12,41 @@ class ClientGameInfo : public GameInfo {
 public:
     explicit ClientGameInfo(std::string player_name);
 
-    DrawMessage::draw_message_optional handle_server_message(ServerMessage::server_message &msg);
+    DrawState *handle_server_message(ServerMessage::server_message &msg);
+    // Draw for gui is owned by game info and updated by the next calls,
+    // its message is built when it's sent, nullptr is returned when there
+    // is nothing to draw.
+    // Applies events while they're read from the buffer
+    DrawState *handle_turn(TurnReader &msg);
     ClientMessage::client_message_optional handle_GUI_message(InputMessage::input_message &msg);
 
 private:
+    friend class TurnReader;
+
     std::string player_name_;
     std::unordered_set<Position, Position::Hash> explosions;
+    DrawState draw_state_;
+
+    DrawState *generate_draw_message();
 
-    DrawMessage::draw_message_optional generate_draw_message();
+    DrawState *handle_hello(ServerMessage::Hello &msg);
+    DrawState *handle_accepted_player(ServerMessage::AcceptedPlayer &msg);
+    DrawState *handle_game_started(ServerMessage::GameStarted &msg);
+    DrawState *handle_turn(ServerMessage::Turn &msg);
+    DrawState *handle_game_ended();
 
-    DrawMessage::draw_message_optional handle_hello(ServerMessage::Hello &msg);
-    DrawMessage::draw_message_optional handle_accepted_player(ServerMessage::AcceptedPlayer &msg);
-    DrawMessage::draw_message_optional handle_game_started(ServerMessage::GameStarted &msg);
-    DrawMessage::draw_message_optional handle_turn(ServerMessage::Turn &msg);
-    DrawMessage::draw_message_optional handle_game_ended();
+    bool start_turn(uint16_t new_turn);
+    DrawState *finish_turn();
 
     void handle_event(Event::event_message &event);
     void handle_bomb_placed(Event::BombPlacedEvent &event);
-    void handle_bomb_exploded(Event::BombExplodedEvent &event);
+    void handle_bomb_exploded(bomb_id_t id);
+    void handle_robot_destroyed(player_id_t id);
+    void handle_block_destroyed(Position &block);
     void handle_player_moved(Event::PlayerMovedEvent &event);
     void handle_block_placed(Event::BlockPlacedEvent &event);
 
-    void handle_explosion_for_position(int32_t x, int32_t y, bool &is_direction_ok) override;
+    void handle_explosion_for_position(Position &position, bool is_block);
 };
 
 #endif //ROBOTS_CLIENT_GAME_INFO_H
@@ -0,0 +1,133 @@
+#include "draw_state.h"
+
+using namespace std;
+
+DrawState::DrawState() : message_(),
+                         block_indexes_(),
+                         bomb_indexes_(),
+                         bomb_ids_(),
+                         explosion_turns_(),
+                         timers_turn_(0) {}
+
+void DrawState::set_lobby(DrawMessage::Lobby &&lobby) {
+    message_ = move(lobby);
+}
+
+void DrawState::start_game(GameBasicInfo &info, const map<player_id_t, PlayerInfo> &players) {
+    message_.emplace<DrawMessage::Game>(info, players);
+    block_indexes_.clear();
+    bomb_indexes_.clear();
+    bomb_ids_.clear();
+    explosion_turns_.clear();
+    timers_turn_ = 0;
+}
+
+void DrawState::start_turn(uint16_t turn) {
+    DrawMessage::Game &game = get_game();
+
+    game.turn = turn;
+    game.explosions.clear();
+}
+
+void DrawState::move_player(player_id_t id, const Position &position) {
+    get_game().player_positions[id] = position;
+}
+
+void DrawState::set_score(player_id_t id, score_t score) {
+    get_game().scores[id] = score;
+}
+
+void DrawState::place_bomb(bomb_id_t id, const Position &position, uint16_t timer) {
+    DrawMessage::Game &game = get_game();
+    auto [it, inserted] = bomb_indexes_.try_emplace(id, game.bombs_.size());
+    auto explosion_turn = static_cast<uint16_t>(game.turn + timer);
+
+    // timer is set for the current turn, it's computed again only when turn changes
+    if (inserted) {
+        game.bombs_.push_back(Bomb{position, timer});
+        bomb_ids_.push_back(id);
+        explosion_turns_.push_back(explosion_turn);
+    } else {
+        game.bombs_[it->second] = Bomb{position, timer};
+        explosion_turns_[it->second] = explosion_turn;
+    }
+}
+
+const Position *DrawState::find_bomb(bomb_id_t id) const {
+    auto it = bomb_indexes_.find(id);
+    if (it == bomb_indexes_.end()) {
+        return nullptr;
+    }
+
+    return &get<DrawMessage::Game>(message_).bombs_[it->second].position;
+}
+
+void DrawState::erase_bomb(bomb_id_t id) {
+    auto it = bomb_indexes_.find(id);
+    if (it == bomb_indexes_.end()) {
+        return;
+    }
+
+    DrawMessage::Game &game = get_game();
+    size_t index = it->second;
+    bomb_indexes_.erase(it);
+
+    if (index != game.bombs_.size() - 1) {
+        game.bombs_[index] = game.bombs_.back();
+        bomb_ids_[index] = bomb_ids_.back();
+        explosion_turns_[index] = explosion_turns_.back();
+        bomb_indexes_[bomb_ids_[index]] = index;
+    }
+    game.bombs_.pop_back();
+    bomb_ids_.pop_back();
+    explosion_turns_.pop_back();
+}
+
+void DrawState::place_block(const Position &position) {
+    DrawMessage::Game &game = get_game();
+
+    if (block_indexes_.try_emplace(get_key(position), game.blocks.size()).second) {
+        game.blocks.push_back(position);
+    }
+}
+
+void DrawState::erase_block(const Position &position) {
+    auto it = block_indexes_.find(get_key(position));
+    if (it == block_indexes_.end()) {
+        return;
+    }
+
+    DrawMessage::Game &game = get_game();
+    size_t index = it->second;
+    block_indexes_.erase(it);
+
+    if (index != game.blocks.size() - 1) {
+        game.blocks[index] = game.blocks.back();
+        block_indexes_[get_key(game.blocks[index])] = index;
+    }
+    game.blocks.pop_back();
+}
+
+void DrawState::add_explosion(const Position &position) {
+    get_game().explosions.push_back(position);
+}
+
+const DrawMessage::draw_message &DrawState::get_message() {
+    if (message_.index() == DrawMessage::GAME && timers_turn_ != get_game().turn) {
+        DrawMessage::Game &game = get_game();
+        for (size_t i = 0; i < game.bombs_.size(); i++) {
+            game.bombs_[i].timer = static_cast<uint16_t>(explosion_turns_[i] - game.turn);
+        }
+        timers_turn_ = game.turn;
+    }
+
+    return message_;
+}
+
+DrawMessage::Game &DrawState::get_game() {
+    return get<DrawMessage::Game>(message_);
+}
+
+uint32_t DrawState::get_key(const Position &position) {
+    return (static_cast<uint32_t>(position.x) << 16) | position.y;
+}
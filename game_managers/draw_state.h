@@ -0,0 +1,57 @@
+#ifndef ROBOTS_DRAW_STATE_H
+#define ROBOTS_DRAW_STATE_H
+
+#include "../structures.h"
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+// Message for gui kept ready to be sent. During a game it's updated by
+// events of turns, so board and players aren't built again for every turn.
+// Bombs keep their explosion turns and their timers are computed only when
+// the message is taken, so turns with draws, which aren't sent, don't touch
+// all bombs. Blocks and bombs are removed by moving the last one in their
+// place, so they're in arbitrary order.
+class DrawState {
+public:
+    DrawState();
+
+    void set_lobby(DrawMessage::Lobby &&lobby);
+    // Players are placed on their positions, there are no blocks and bombs
+    void start_game(GameBasicInfo &info, const std::map<player_id_t, PlayerInfo> &players);
+    // Explosions of the previous turn are removed
+    void start_turn(uint16_t turn);
+
+    void move_player(player_id_t id, const Position &position);
+    void set_score(player_id_t id, score_t score);
+
+    void place_bomb(bomb_id_t id, const Position &position, uint16_t timer);
+    // returns nullptr for unknown bomb
+    const Position *find_bomb(bomb_id_t id) const;
+    void erase_bomb(bomb_id_t id);
+
+    void place_block(const Position &position);
+    void erase_block(const Position &position);
+    void add_explosion(const Position &position);
+
+    // Timers of bombs are brought up to the current turn
+    const DrawMessage::draw_message &get_message();
+
+private:
+    DrawMessage::draw_message message_;
+    // indexes in vectors of the game message
+    std::unordered_map<uint32_t, size_t> block_indexes_;
+    std::unordered_map<bomb_id_t, size_t> bomb_indexes_;
+    // ids and explosion turns of bombs in order of the game message
+    std::vector<bomb_id_t> bomb_ids_;
+    std::vector<uint16_t> explosion_turns_;
+    // turn, for which timers of bombs in the message were computed
+    uint16_t timers_turn_;
+
+    DrawMessage::Game &get_game();
+
+    static uint32_t get_key(const Position &position);
+};
+
+#endif //ROBOTS_DRAW_STATE_H
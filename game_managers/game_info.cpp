@@ -1,4 +1,5 @@
 #include "game_info.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -8,8 +9,8 @@ GameInfo::GameInfo(ServerParameters &params) : basic_info(params),
                                                bomb_timer(params.get_bomb_timer()),
                                                turn(0),
                                                players(),
-                                               bombs(),
-                                               blocks(),
+                                               blocks(basic_info.size_x_, basic_info.size_y_),
+                                               players_on_positions(),
                                                destroyed_robots() {}
 
 bool GameInfo::is_position_on_board(int32_t x, int32_t y) const {
@@ -20,41 +21,65 @@ bool GameInfo::is_position_on_board(int32_t x, int32_t y) const {
 void GameInfo::clean_after_game() {
     state = GameState::Lobby;
     players.clear();
-    bombs.clear();
     blocks.clear();
+    players_on_positions.clear();
     turn = 0;
 }
 
-bool GameInfo::is_block_on_position(Position &position) {
-    return blocks.find(position) != blocks.end();
+bool GameInfo::is_block_on_position(const Position &position) const {
+    return blocks.contains(position);
 }
 
-void GameInfo::make_bomb_explosion(Position &bomb_position) {
-    const uint8_t DIRECTIONS_NO = 4;
-    bool is_bomb_on_empty = true;
-    bool is_direction_ok[DIRECTIONS_NO];
-    
-    handle_explosion_for_position(bomb_position.x, bomb_position.y, is_bomb_on_empty);
-    memset(is_direction_ok, is_bomb_on_empty, DIRECTIONS_NO);
-
-    int32_t x = bomb_position.x;
-    int32_t y = bomb_position.y;
-    for (int32_t i = 1; i <= explosion_radius; i++) {
-        handle_explosion_for_position(x, y + i, is_direction_ok[Direction::UP]);
-        handle_explosion_for_position(x + i, y, is_direction_ok[Direction::RIGHT]);
-        handle_explosion_for_position(x, y - i, is_direction_ok[Direction::DOWN]);
-        handle_explosion_for_position(x - i, y, is_direction_ok[Direction::LEFT]);
+GameInfo::ExplosionRays GameInfo::get_explosion_rays(const Position &bomb_position) const {
+    ExplosionRays rays{{}, 0};
+
+    for (uint8_t i = 0; i < DIRECTIONS_NO; i++) {
+        auto direction = static_cast<Direction>(i);
+        uint32_t max_distance = min<uint32_t>(explosion_radius, get_distance_to_edge(bomb_position, direction));
+
+        rays.length[i] = min(max_distance, blocks.get_distance_to_block(bomb_position, direction, max_distance));
+        rays.max_length = max(rays.max_length, rays.length[i]);
+    }
+
+    return rays;
+}
+
+uint32_t GameInfo::get_distance_to_edge(const Position &position, Direction direction) const {
+    switch (direction) {
+        case Direction::UP :
+            return static_cast<uint32_t>(basic_info.size_y_ - 1 - position.y);
+        case Direction::RIGHT :
+            return static_cast<uint32_t>(basic_info.size_x_ - 1 - position.x);
+        case Direction::DOWN :
+            return position.y;
+        default:
+            return position.x;
     }
 }
 
-vector<player_id_t> GameInfo::get_players_on_position(Position &position) {
-    vector<player_id_t> result;
+Position GameInfo::get_moved_position(const Position &position, Direction direction, uint32_t distance) {
+    auto x = static_cast<uint32_t>(position.x);
+    auto y = static_cast<uint32_t>(position.y);
 
-    for (auto &[id, player]: players) {
-        if (player.position == position) {
-            result.emplace_back(id);
-        }
+    switch (direction) {
+        case Direction::UP :
+            y += distance;
+            break;
+        case Direction::RIGHT :
+            x += distance;
+            break;
+        case Direction::DOWN :
+            y -= distance;
+            break;
+        default:
+            x -= distance;
     }
 
-    return result;
+    return {static_cast<board_coord_t>(x), static_cast<board_coord_t>(y)};
+}
+
+void GameInfo::set_player_position(PlayerInfo &player, const Position &position) {
+    players_on_positions.remove(player.id, player.position);
+    player.position = position;
+    players_on_positions.add(player.id, player.position);
 }
@@ -2,6 +2,8 @@
 #define ROBOTS_GAME_INFO_H
 
 #include "../structures.h"
+#include "block_grid.h"
+#include "player_occupancy.h"
 #include <map>
 #include <unordered_set>
 
@@ -19,8 +21,8 @@ protected:
     uint16_t bomb_timer{};
     uint16_t turn{};
     std::map<player_id_t, PlayerInfo> players;
-    std::map<bomb_id_t, Bomb> bombs;
-    std::unordered_set<Position, Position::Hash> blocks;
+    BlockGrid blocks;
+    PlayerOccupancy players_on_positions;
     std::unordered_set<player_id_t> destroyed_robots;
     GameState state{NotConnected};
 
@@ -28,16 +30,53 @@ protected:
     explicit GameInfo(ServerParameters &params);
 
     bool is_position_on_board(int32_t x, int32_t y) const;
-    bool is_block_on_position(Position &position);
+    bool is_block_on_position(const Position &position) const;
 
-    std::vector<player_id_t> get_players_on_position(Position &position);
+    // Positions of players have to be changed only by this function
+    void set_player_position(PlayerInfo &player, const Position &position);
 
     void clean_after_game();
 
-    void make_bomb_explosion(Position &bomb_position);
+    // Calls handle_cell(position, is_block) for every cell reached by explosion,
+    // rays stop at the first block or after explosion_radius cells.
+    // Handler is a template parameter, so it's inlined into the loop.
+    template<typename CellHandler>
+    void make_bomb_explosion(Position &bomb_position, CellHandler handle_cell) const {
+        if (!is_position_on_board(bomb_position.x, bomb_position.y)) {
+            return;
+        }
+
+        bool is_block_on_bomb = is_block_on_position(bomb_position);
+        handle_cell(bomb_position, is_block_on_bomb);
+        if (is_block_on_bomb) {
+            return;
+        }
+
+        ExplosionRays rays = get_explosion_rays(bomb_position);
+
+        // cells are visited by distance from the bomb and then by direction
+        for (uint32_t distance = 1; distance <= rays.max_length; distance++) {
+            for (uint8_t i = 0; i < DIRECTIONS_NO; i++) {
+                if (distance <= rays.length[i]) {
+                    Position position = get_moved_position(bomb_position, static_cast<Direction>(i), distance);
+                    handle_cell(position, is_block_on_position(position));
+                }
+            }
+        }
+    }
 
 private:
-    virtual void handle_explosion_for_position(int32_t x, int32_t y, bool &is_direction_ok) = 0;
+    static constexpr uint8_t DIRECTIONS_NO = 4;
+
+    // number of cells reached in every direction, only the last one can be a block
+    struct ExplosionRays {
+        uint32_t length[DIRECTIONS_NO];
+        uint32_t max_length;
+    };
+
+    ExplosionRays get_explosion_rays(const Position &bomb_position) const;
+    uint32_t get_distance_to_edge(const Position &position, Direction direction) const;
+    static Position get_moved_position(const Position &position, Direction direction, uint32_t distance);
 };
 
 #endif //ROBOTS_GAME_INFO_H
\ No newline at end of file
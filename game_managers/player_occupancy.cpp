@@ -0,0 +1,34 @@
+#include "player_occupancy.h"
+
+using namespace std;
+
+PlayerOccupancy::PlayerOccupancy() : cells_() {}
+
+void PlayerOccupancy::add(player_id_t id, const Position &position) {
+    cells_[get_key(position)][id / WORD_BITS] |= uint64_t{1} << (id % WORD_BITS);
+}
+
+void PlayerOccupancy::remove(player_id_t id, const Position &position) {
+    auto cell = cells_.find(get_key(position));
+    if (cell == cells_.end()) {
+        return;
+    }
+
+    players_set &players = cell->second;
+    players[id / WORD_BITS] &= ~(uint64_t{1} << (id % WORD_BITS));
+
+    for (auto word: players) {
+        if (word != 0) {
+            return;
+        }
+    }
+    cells_.erase(cell);
+}
+
+void PlayerOccupancy::clear() {
+    cells_.clear();
+}
+
+uint32_t PlayerOccupancy::get_key(const Position &position) {
+    return (static_cast<uint32_t>(position.x) << 16) | position.y;
+}
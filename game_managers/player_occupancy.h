@@ -0,0 +1,47 @@
+#ifndef ROBOTS_PLAYER_OCCUPANCY_H
+#define ROBOTS_PLAYER_OCCUPANCY_H
+
+#include "../structures.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+// Index of players standing on every occupied cell of the board,
+// kept as a set of player ids for every cell with at least one player
+class PlayerOccupancy {
+public:
+    PlayerOccupancy();
+
+    void add(player_id_t id, const Position &position);
+    void remove(player_id_t id, const Position &position);
+    void clear();
+
+    // Calls f for every player on position, ordered by id
+    template<typename F>
+    void for_each_player_on(const Position &position, F f) const {
+        auto cell = cells_.find(get_key(position));
+        if (cell == cells_.end()) {
+            return;
+        }
+
+        for (size_t word = 0; word < WORDS_NO; word++) {
+            for (uint64_t bits = cell->second[word]; bits != 0; bits &= bits - 1) {
+                f(static_cast<player_id_t>(word * WORD_BITS + static_cast<size_t>(std::countr_zero(bits))));
+            }
+        }
+    }
+
+private:
+    static constexpr size_t WORD_BITS = 64;
+    static constexpr size_t WORDS_NO = (std::numeric_limits<player_id_t>::max() + 1) / WORD_BITS;
+
+    using players_set = std::array<uint64_t, WORDS_NO>;
+
+    std::unordered_map<uint32_t, players_set> cells_;
+
+    static uint32_t get_key(const Position &position);
+};
+
+#endif //ROBOTS_PLAYER_OCCUPANCY_H
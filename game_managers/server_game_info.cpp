@@ -1,16 +1,42 @@
 #include "server_game_info.h"
 #include "../logger.h"
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
 
 using namespace std;
 
-ServerGameInfo::ServerGameInfo(ServerParameters &params) : GameInfo(params),
-                                                           initial_blocks_(params.get_initial_blocks()),
-                                                           random_engine_(params.get_seed()),
-                                                           events_(),
-                                                           destroyed_blocks_(),
-                                                           destroyed_blocks_in_explosion_(),
-                                                           destroyed_robots_in_explosion_(),
-                                                           next_bomb_id(0) {
+namespace {
+    // allocator of pmr vector can't be changed by assignment, so vector is created again
+    template<typename T>
+    void recreate_in(pmr::vector<T> &vector, pmr::memory_resource *memory_resource) {
+        destroy_at(&vector);
+        construct_at(&vector, memory_resource);
+    }
+}
+
+ServerGameInfo::ServerGameInfo(ServerParameters &params, uint32_t seed,
+                               WorkerPool *workers) : GameInfo(params),
+                                                      initial_blocks_(params.get_initial_blocks()),
+                                                      random_engine_(seed),
+                                                      workers_(workers),
+                                                      bombs_(params.get_bomb_timer()),
+                                                      turn_arenas_{std::make_shared<TurnArena>(),
+                                                                   std::make_shared<TurnArena>()},
+                                                      turn_arena_(turn_arenas_[0]),
+                                                      events_(turn_arena_->get_resource()),
+                                                      destroyed_blocks_(),
+                                                      destroyed_blocks_in_explosion_(turn_arena_->get_resource()),
+                                                      destroyed_robots_in_explosion_(turn_arena_->get_resource()),
+                                                      exploding_bombs_(),
+                                                      explosion_results_(),
+                                                      is_snapshot_needed_(params.is_snapshot_catch_up() ||
+                                                                          params.get_slow_client_policy() ==
+                                                                          SlowClientPolicy::SNAPSHOT),
+                                                      last_explosions_(),
+                                                      kills_(),
+                                                      next_bomb_id(0) {
     this->state = GameState::Lobby;
 }
 
@@ -26,29 +52,24 @@ ServerGameInfo::start_game_messages ServerGameInfo::start_game() {
     state = GameState::Game;
     initialize_board();
 
-    return {ServerMessage::GameStarted{players}, ServerMessage::Turn{turn++, events_}};
+    return {ServerMessage::GameStarted{players}, TurnMessage{{turn++, move(events_)}, turn_arena_}};
 }
 
 ServerMessage::GameEnded ServerGameInfo::end_game() {
     ServerMessage::GameEnded result{players};
     clean_after_game();
+    bombs_.clear();
 
     return result;
 }
 
-ServerMessage::Turn ServerGameInfo::handle_turn(unordered_map<player_id_t, ClientMessage::client_message> &msgs) {
-    events_.clear();
+ServerGameInfo::TurnMessage ServerGameInfo::handle_turn(unordered_map<player_id_t, ClientMessage::client_message> &msgs) {
+    start_new_turn();
     destroyed_robots.clear();
     destroyed_blocks_.clear();
+    last_explosions_.clear();
 
-    for (auto it = bombs.begin(); it != bombs.end();) {
-        if (--(it->second.timer) == 0) {
-            handle_bomb_explosion(it->first, it->second.position);
-            it = bombs.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    handle_bomb_explosions();
 
     for (auto &[id, player]: players) {
         if (destroyed_robots.find(id) == destroyed_robots.end()) {
@@ -64,7 +85,7 @@ ServerMessage::Turn ServerGameInfo::handle_turn(unordered_map<player_id_t, Clien
         blocks.erase(it);
     }
 
-    return {turn++, events_};
+    return {{turn++, move(events_)}, turn_arena_};
 }
 
 optional<ServerMessage::AcceptedPlayer>
@@ -87,6 +108,21 @@ ServerGameInfo::handle_client_join_message(ClientMessage::Join &msg, string &&ad
     return ServerMessage::AcceptedPlayer{new_player_id, new_player};
 }
 
+vector<ServerMessage::server_message> ServerGameInfo::get_catch_up_messages() const {
+    vector<ServerMessage::server_message> result;
+
+    if (state == GameState::Lobby) {
+        for (auto &[id, player]: players) {
+            result.emplace_back(ServerMessage::AcceptedPlayer{id, player.player});
+        }
+    } else {
+        result.emplace_back(ServerMessage::GameStarted{players});
+        add_board_turns(result);
+    }
+
+    return result;
+}
+
 void ServerGameInfo::handle_client_message_in_game(ClientMessage::client_message &msg, PlayerInfo &player) {
     if (state != GameState::Game) {
         return;
@@ -110,19 +146,43 @@ void ServerGameInfo::handle_client_message_in_game(ClientMessage::client_message
     }
 }
 
+void ServerGameInfo::start_new_turn() {
+    shared_turn_arena &arena = turn_arenas_[turn % TURN_ARENAS_NO];
+    turn_arena_.reset();
+
+    if (arena.use_count() > 1) {
+        // turn from two turns ago is still used, so its memory is left to its users
+        arena = make_shared<TurnArena>();
+    } else {
+        // last user released arena with release order, it's synchronized with this fence
+        atomic_thread_fence(memory_order_acquire);
+    }
+    turn_arena_ = arena;
+
+    // vectors can't keep memory, which is going to be released
+    recreate_in(events_, turn_arena_->get_resource());
+    recreate_in(destroyed_blocks_in_explosion_, turn_arena_->get_resource());
+    recreate_in(destroyed_robots_in_explosion_, turn_arena_->get_resource());
+
+    turn_arena_->release();
+}
+
 void ServerGameInfo::initialize_board() {
     next_bomb_id = 0;
-    events_.clear();
+    destroyed_robots.clear();
+    exploding_bombs_.clear();
+    last_explosions_.clear();
+    kills_.clear();
+    start_new_turn();
 
     for (auto &[id, player]: players) {
-        player.position = get_random_position();
+        set_player_position(player, get_random_position());
         events_.emplace_back(Event::PlayerMovedEvent{id, player.position});
     }
 
     for (uint16_t i = 0; i < initial_blocks_; i++) {
         Position block_position = get_random_position();
-        auto[it, is_inserted] = blocks.emplace(block_position);
-        if (is_inserted) {
+        if (blocks.insert(block_position)) {
             events_.emplace_back(Event::BlockPlacedEvent{block_position});
         }
     }
@@ -131,7 +191,7 @@ void ServerGameInfo::initialize_board() {
 void ServerGameInfo::handle_place_bomb(Position &bomb_position) {
     bomb_id_t new_bomb_id = next_bomb_id++;
 
-    bombs.emplace(new_bomb_id, Bomb{bomb_position, bomb_timer});
+    bombs_.place(new_bomb_id, bomb_position, turn);
     events_.emplace_back(Event::BombPlacedEvent{new_bomb_id, bomb_position});
 }
 
@@ -140,7 +200,7 @@ void ServerGameInfo::handle_place_block(Position &block_position) {
         return;
     }
 
-    blocks.emplace(block_position);
+    blocks.insert(block_position);
     events_.emplace_back(Event::BlockPlacedEvent{block_position});
 }
 
@@ -156,27 +216,157 @@ void ServerGameInfo::handle_move(ClientMessage::Move &msg, PlayerInfo &player) {
         return;
     }
 
-    player.position = possible_new_position;
+    set_player_position(player, possible_new_position);
 
     events_.emplace_back(Event::PlayerMovedEvent{player.id, player.position});
 }
 
+void ServerGameInfo::handle_bomb_explosions() {
+    exploding_bombs_.clear();
+    bombs_.explode(turn, [this](bomb_id_t id, Position &position) {
+        exploding_bombs_.emplace_back(id, position);
+    });
+
+    size_t parts_no = 1;
+    if (workers_ != nullptr && exploding_bombs_.size() >= PARALLEL_EXPLOSIONS_THRESHOLD) {
+        parts_no = clamp<size_t>(exploding_bombs_.size() / MIN_EXPLOSIONS_PER_PART,
+                                 1, workers_->get_parallelism());
+    }
+
+    if (parts_no > 1) {
+        handle_bomb_explosions_in_parallel(parts_no);
+    } else {
+        for (auto &[id, position]: exploding_bombs_) {
+            handle_bomb_explosion(id, position);
+        }
+    }
+}
+
+void ServerGameInfo::handle_bomb_explosions_in_parallel(size_t parts_no) {
+    size_t bombs_no = exploding_bombs_.size();
+    size_t chunk = (bombs_no + parts_no - 1) / parts_no;
+    explosion_results_.resize(bombs_no);
+
+    auto compute_chunk = [this, bombs_no, chunk](size_t part) {
+        for (size_t i = part * chunk; i < min(bombs_no, (part + 1) * chunk); i++) {
+            compute_explosion(exploding_bombs_[i].second, explosion_results_[i]);
+        }
+    };
+
+    workers_->run(parts_no, compute_chunk);
+
+    // arena isn't thread safe, so results are copied to it after all parts finished
+    for (size_t i = 0; i < bombs_no; i++) {
+        ExplosionResult &result = explosion_results_[i];
+
+        destroyed_robots.insert(result.robots_destroyed.begin(), result.robots_destroyed.end());
+        destroyed_blocks_.insert(result.blocks_destroyed.begin(), result.blocks_destroyed.end());
+
+        events_.emplace_back(Event::BombExplodedEvent{
+                exploding_bombs_[i].first,
+                pmr::vector<player_id_t>(result.robots_destroyed.begin(), result.robots_destroyed.end(),
+                                         turn_arena_->get_resource()),
+                pmr::vector<Position>(result.blocks_destroyed.begin(), result.blocks_destroyed.end(),
+                                      turn_arena_->get_resource())});
+        save_last_explosion();
+    }
+}
+
+void ServerGameInfo::compute_explosion(Position &bomb_position, ExplosionResult &result) const {
+    result.robots_destroyed.clear();
+    result.blocks_destroyed.clear();
+
+    make_bomb_explosion(bomb_position, [this, &result](Position &position, bool is_block) {
+        if (is_block) {
+            result.blocks_destroyed.emplace_back(position);
+        }
+
+        players_on_positions.for_each_player_on(position, [&result](player_id_t id) {
+            result.robots_destroyed.emplace_back(id);
+        });
+    });
+}
+
 void ServerGameInfo::handle_bomb_explosion(bomb_id_t bomb_id, Position &bomb_position) {
     destroyed_blocks_in_explosion_.clear();
     destroyed_robots_in_explosion_.clear();
 
-    make_bomb_explosion(bomb_position);
+    make_bomb_explosion(bomb_position, [this](Position &position, bool is_block) {
+        handle_explosion_for_position(position, is_block);
+    });
 
-    events_.emplace_back(Event::BombExplodedEvent{bomb_id, destroyed_robots_in_explosion_, destroyed_blocks_in_explosion_});
+    events_.emplace_back(Event::BombExplodedEvent{bomb_id, move(destroyed_robots_in_explosion_),
+                                                  move(destroyed_blocks_in_explosion_)});
+    save_last_explosion();
+}
+
+void ServerGameInfo::save_last_explosion() {
+    if (!is_snapshot_needed_) {
+        return;
+    }
+
+    // copies are made in default memory, arena of turn is reused
+    auto &explosion = get<Event::BombExplodedEvent>(events_.back());
+    last_explosions_.emplace_back(explosion);
+    if (!explosion.robots_destroyed.empty()) {
+        // blocks are sent with the board
+        kills_.emplace_back(turn, Event::BombExplodedEvent{explosion.id, explosion.robots_destroyed, {}});
+    }
 }
 
 void ServerGameInfo::handle_player_killed(PlayerInfo &player) {
     player.score++;
-    player.position = get_random_position();
+    set_player_position(player, get_random_position());
 
     events_.emplace_back(Event::PlayerMovedEvent{player.id, player.position});
 }
 
+void ServerGameInfo::add_board_turns(vector<ServerMessage::server_message> &msgs) const {
+    auto last_turn = static_cast<uint16_t>(turn - 1);
+    // turns of snapshot have to come in order, so client computes the same timers
+    map<uint16_t, ServerMessage::Turn> turns;
+    auto get_turn = [&turns](uint16_t turn_no) -> ServerMessage::Turn & {
+        return turns.try_emplace(turn_no, ServerMessage::Turn{turn_no, {}}).first->second;
+    };
+    auto add_bomb = [&get_turn](bomb_id_t id, const Position &position, uint16_t placed_turn) {
+        get_turn(placed_turn).events.emplace_back(Event::BombPlacedEvent{id, position});
+    };
+
+    // client gives points for the same turns as server, explosions of the last turn are repeated below
+    for (auto &[kill_turn, explosion]: kills_) {
+        if (kill_turn != last_turn) {
+            get_turn(kill_turn).events.emplace_back(explosion);
+        }
+    }
+
+    // bombs exploded in the last turn are placed too, so client computes their explosions
+    if (!last_explosions_.empty()) {
+        for (auto &[id, position]: exploding_bombs_) {
+            add_bomb(id, position, static_cast<uint16_t>(last_turn - bomb_timer));
+        }
+    }
+    bombs_.for_each_placed(add_bomb);
+
+    // the last turn starts with board from before its explosions,
+    // so client computes them and erases blocks like after the real turn
+    ServerMessage::Turn &current = get_turn(last_turn);
+    blocks.for_each([&current](const Position &position) {
+        current.events.emplace_back(Event::BlockPlacedEvent{position});
+    });
+    for (auto &position: destroyed_blocks_) {
+        current.events.emplace_back(Event::BlockPlacedEvent{position});
+    }
+    current.events.insert(current.events.end(), last_explosions_.begin(), last_explosions_.end());
+
+    for (auto &[id, player]: players) {
+        current.events.emplace_back(Event::PlayerMovedEvent{id, player.position});
+    }
+
+    for (auto &[turn_no, snapshot_turn]: turns) {
+        msgs.emplace_back(move(snapshot_turn));
+    }
+}
+
 Position ServerGameInfo::get_random_position() {
     board_coord_t x = static_cast<board_coord_t>(random_engine_() % basic_info.size_x_);
     board_coord_t y = static_cast<board_coord_t>(random_engine_() % basic_info.size_y_);
@@ -184,23 +374,14 @@ Position ServerGameInfo::get_random_position() {
     return {x, y};
 }
 
-void ServerGameInfo::handle_explosion_for_position(int32_t x, int32_t y, bool &is_direction_ok) {
-    if (is_direction_ok && is_position_on_board(x, y)) {
-        Position position = {static_cast<uint16_t>(x), static_cast<uint16_t>(y)};
-
-        if (is_block_on_position(position)) {
-            destroyed_blocks_in_explosion_.emplace_back(position);
-            destroyed_blocks_.emplace(position);
-
-            is_direction_ok = false;
-        }
-
-        vector<player_id_t> robots_to_destroy = get_players_on_position(position);
-        for (auto &id: robots_to_destroy) {
-            destroyed_robots_in_explosion_.emplace_back(id);
-            destroyed_robots.emplace(id);
-        }
-    } else {
-        is_direction_ok = false;
+void ServerGameInfo::handle_explosion_for_position(Position &position, bool is_block) {
+    if (is_block) {
+        destroyed_blocks_in_explosion_.emplace_back(position);
+        destroyed_blocks_.emplace(position);
     }
+
+    players_on_positions.for_each_player_on(position, [this](player_id_t id) {
+        destroyed_robots_in_explosion_.emplace_back(id);
+        destroyed_robots.emplace(id);
+    });
 }
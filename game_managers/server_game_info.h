@@ -2,7 +2,11 @@
 #define ROBOTS_SERVER_GAME_INFO_H
 
 #include "../structures.h"
+#include "../turn_arena.h"
+#include "bomb_wheel.h"
 #include "game_info.h"
+#include "worker_pool.h"
+#include <array>
 #include <random>
 #include <unordered_set>
 #include <unordered_map>
@@ -10,9 +14,18 @@
 
 class ServerGameInfo : public GameInfo {
 public:
-    using start_game_messages = std::pair<ServerMessage::GameStarted, ServerMessage::Turn>;
+    // Events of turn are allocated in its arena, which is reused only
+    // when nobody else keeps it, so it has to be kept until turn is sent
+    struct TurnMessage {
+        ServerMessage::Turn turn;
+        shared_turn_arena arena;
+    };
 
-    explicit ServerGameInfo(ServerParameters &params);
+    using start_game_messages = std::pair<ServerMessage::GameStarted, TurnMessage>;
+
+    // Many explosions of one turn are split between workers, without them
+    // everything is computed by the calling thread
+    ServerGameInfo(ServerParameters &params, uint32_t seed, WorkerPool *workers = nullptr);
 
     bool is_enough_players() const;
     bool is_end_of_game() const;
@@ -20,18 +33,48 @@ public:
     start_game_messages start_game();
     ServerMessage::GameEnded end_game();
 
-    ServerMessage::Turn handle_turn(std::unordered_map<player_id_t, ClientMessage::client_message> &msgs);
+    TurnMessage handle_turn(std::unordered_map<player_id_t, ClientMessage::client_message> &msgs);
     std::optional<ServerMessage::AcceptedPlayer> handle_client_join_message(ClientMessage::Join &msg, std::string &&address);
 
+    // Messages bringing new connection to the current state - accepted players
+    // in lobby or started game with snapshot of the board. Their size depends
+    // on the board and scores, not on the number of played turns.
+    std::vector<ServerMessage::server_message> get_catch_up_messages() const;
+
 private:
+    // memory of turns is double-buffered, so the previous turn can be still
+    // sent by other thread, when the next one is computed
+    static constexpr size_t TURN_ARENAS_NO = 2;
+    // explosions are resolved by many threads only when there are enough of them
+    static constexpr size_t PARALLEL_EXPLOSIONS_THRESHOLD = 128;
+    static constexpr size_t MIN_EXPLOSIONS_PER_PART = 32;
+
+    struct ExplosionResult {
+        std::vector<player_id_t> robots_destroyed;
+        std::vector<Position> blocks_destroyed;
+    };
+
     uint16_t initial_blocks_;
     std::minstd_rand random_engine_;
-    std::vector<Event::event_message> events_;
+    WorkerPool *workers_;
+    // only server schedules explosions, client keeps bombs in its draw state
+    BombWheel bombs_;
+    std::array<shared_turn_arena, TURN_ARENAS_NO> turn_arenas_;
+    shared_turn_arena turn_arena_;
+    std::pmr::vector<Event::event_message> events_;
     std::unordered_set<Position, Position::Hash> destroyed_blocks_;
-    std::vector<Position> destroyed_blocks_in_explosion_;
-    std::vector<player_id_t> destroyed_robots_in_explosion_;
+    std::pmr::vector<Position> destroyed_blocks_in_explosion_;
+    std::pmr::vector<player_id_t> destroyed_robots_in_explosion_;
+    std::vector<std::pair<bomb_id_t, Position>> exploding_bombs_;
+    std::vector<ExplosionResult> explosion_results_;
+    // explosions of the last turn and explosions, which destroyed robots,
+    // are repeated by snapshot, so they're kept only when snapshots can be sent
+    bool is_snapshot_needed_;
+    std::vector<Event::BombExplodedEvent> last_explosions_;
+    std::vector<std::pair<uint16_t, Event::BombExplodedEvent>> kills_;
     uint32_t next_bomb_id;
 
+    void start_new_turn();
     void initialize_board();
 
     void handle_client_message_in_game(ClientMessage::client_message &msg, PlayerInfo &player);
@@ -40,12 +83,20 @@ private:
     void handle_place_block(Position &block_position);
     void handle_move(ClientMessage::Move &msg, PlayerInfo &player);
 
+    void handle_bomb_explosions();
     void handle_bomb_explosion(bomb_id_t bomb_id, Position &bomb_position);
+    // Explosions don't change the board, so they're computed in parallel
+    // and merged in order of bombs, events are the same as in serial path
+    void handle_bomb_explosions_in_parallel(size_t parts_no);
+    void compute_explosion(Position &bomb_position, ExplosionResult &result) const;
     void handle_player_killed(PlayerInfo &player);
 
-    void handle_explosion_for_position(int32_t x, int32_t y, bool &is_direction_ok) override;
+    void handle_explosion_for_position(Position &position, bool is_block);
+    void save_last_explosion();
 
     Position get_random_position();
+
+    void add_board_turns(std::vector<ServerMessage::server_message> &msgs) const;
 };
 
 #endif //ROBOTS_SERVER_GAME_INFO_H
@@ -0,0 +1,55 @@
+#include "worker_pool.h"
+#include <algorithm>
+#include <boost/asio/post.hpp>
+#include <exception>
+#include <latch>
+#include <mutex>
+
+using namespace std;
+
+WorkerPool::WorkerPool(size_t threads_count) : threads_count_(max<size_t>(threads_count, 1)),
+                                               pool_(threads_count_) {}
+
+size_t WorkerPool::get_parallelism() const {
+    return threads_count_ + 1;
+}
+
+void WorkerPool::run(size_t parts_count, const function<void(size_t)> &task) {
+    if (parts_count == 0) {
+        return;
+    }
+
+    latch finished(static_cast<ptrdiff_t>(parts_count - 1));
+    mutex error_mutex;
+    exception_ptr error;
+
+    auto run_part = [&task, &error_mutex, &error](size_t part) {
+        try {
+            task(part);
+        } catch (...) {
+            lock_guard<mutex> lock(error_mutex);
+            error = current_exception();
+        }
+    };
+
+    // parts use memory of this function, so it waits for all posted ones, even after error
+    size_t posted = 1;
+    try {
+        for (; posted < parts_count; posted++) {
+            boost::asio::post(pool_, [&run_part, &finished, posted]() {
+                run_part(posted);
+                finished.count_down();
+            });
+        }
+    } catch (...) {
+        error = current_exception();
+        finished.count_down(static_cast<ptrdiff_t>(parts_count - posted));
+    }
+
+    run_part(0);
+    finished.wait();
+
+    if (error) {
+        rethrow_exception(error);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef ROBOTS_WORKER_POOL_H
+#define ROBOTS_WORKER_POOL_H
+
+#include <boost/asio/thread_pool.hpp>
+#include <cstddef>
+#include <functional>
+
+// Threads shared by all rooms of server for splitting work of one turn.
+// Thread asking for work does one part itself and waits for the others,
+// so parts can use memory of the caller.
+class WorkerPool {
+public:
+    // At least one thread is started, also when threads_count is 0
+    explicit WorkerPool(size_t threads_count);
+
+    // Maximal number of parts done at once, with the calling thread
+    size_t get_parallelism() const;
+
+    // Calls task(part) for every part from 0 to parts_count - 1 and returns
+    // after all of them finished, exception thrown by any part is rethrown
+    void run(size_t parts_count, const std::function<void(size_t)> &task);
+
+private:
+    size_t threads_count_;
+    boost::asio::thread_pool pool_;
+};
+
+#endif //ROBOTS_WORKER_POOL_H
@@ -2,7 +2,9 @@
 #define ROBOTS_LOGGER_H
 
 #include <iostream>
+#include <sstream>
 
+// Every line is written at once, so lines from different threads don't mix
 class Logger {
 private:
 #ifdef NDEBUG
@@ -15,22 +17,24 @@ public:
     template<typename... Args>
     static void print_debug(Args &&...args) {
         if (debug_compile) {
-            (std::cerr << ... << args);
-            std::cerr << "\n";
+            std::ostringstream line;
+            (line << ... << args) << "\n";
+            std::cerr << line.str();
         }
     }
 
     template<typename... Args>
     static void print_info(Args &&...args) {
-        (std::cout << ... << args);
-        std::cout << "\n";
+        std::ostringstream line;
+        (line << ... << args) << "\n";
+        std::cout << line.str();
     }
 
     template<typename... Args>
     static void print_error(Args &&...args) {
-        std::cerr << "Error: ";
-        (std::cerr << ... << args);
-        std::cerr << "\n";
+        std::ostringstream line;
+        (line << "Error: " << ... << args) << "\n";
+        std::cerr << line.str();
     }
 };
 
@@ -1,6 +1,7 @@
 #include "parameters.h"
 #include "logger.h"
 #include <string>
+#include <thread>
 
 namespace po = boost::program_options;
 using namespace std;
@@ -46,7 +47,9 @@ void ClientParameters::initialize_options_description() {
 
     po::options_description optional_description("Optional options");
     optional_description.add_options()
-            ("help,h", "print help information");
+            ("help,h", "print help information")
+            ("latest-draw-only,l", "send gui only the newest draw, when the previous one is still being sent")
+            ("fragmented-draws,f", "send gui draws in numbered fragments, so they can be bigger than a datagram");
 
     opt_description_.add(required_description).add(optional_description);
 }
@@ -67,6 +70,14 @@ Address ClientParameters::get_server_address() {
     return var_map_["server-address"].as<Address>();
 }
 
+bool ClientParameters::is_latest_draw_only() {
+    return var_map_.count("latest-draw-only") > 0;
+}
+
+bool ClientParameters::is_fragmented_draws() {
+    return var_map_.count("fragmented-draws") > 0;
+}
+
 namespace {
     struct u8_t {
         uint8_t value;
@@ -110,6 +121,16 @@ void ServerParameters::initialize_options_description() {
     po::options_description optional_description("Optional options");
     optional_description.add_options()
             ("seed,s", po::value<uint32_t>(), "set seed for random generator")
+            ("rooms,r", po::value<uint16_t>()->default_value(1), "set number of rooms with separate games")
+            ("threads,t", po::value<uint16_t>(), "set number of threads running rooms, one per core by default")
+            ("io-threads,i", po::value<uint16_t>(), "set number of threads handling connections, one per core by default")
+            ("snapshot-catch-up,S", "send late connections snapshot of the game instead of all its turns")
+            ("max-queued-bytes", po::value<uint64_t>()->default_value(1 << 24),
+             "set limit of bytes waiting for sending to one client")
+            ("max-queued-messages", po::value<uint32_t>()->default_value(1 << 12),
+             "set limit of messages waiting for sending to one client")
+            ("slow-client-policy", po::value<SlowClientPolicy>()->default_value(SlowClientPolicy::DISCONNECT),
+             "set what's done with client exceeding limits, arg as disconnect or snapshot")
             ("help,h", "print help information");
 
 
@@ -156,6 +177,42 @@ uint32_t ServerParameters::get_seed() {
     return var_map_["seed"].as<uint32_t>();
 }
 
+uint16_t ServerParameters::get_rooms_count() {
+    return var_map_["rooms"].as<uint16_t>();
+}
+
+uint16_t ServerParameters::get_threads_count() {
+    if (var_map_.count("threads") == 0) {
+        return static_cast<uint16_t>(max(1u, thread::hardware_concurrency()));
+    }
+
+    return var_map_["threads"].as<uint16_t>();
+}
+
+uint16_t ServerParameters::get_io_threads_count() {
+    if (var_map_.count("io-threads") == 0) {
+        return static_cast<uint16_t>(max(1u, thread::hardware_concurrency()));
+    }
+
+    return var_map_["io-threads"].as<uint16_t>();
+}
+
+bool ServerParameters::is_snapshot_catch_up() {
+    return var_map_.count("snapshot-catch-up") > 0;
+}
+
+uint64_t ServerParameters::get_max_queued_bytes() {
+    return var_map_["max-queued-bytes"].as<uint64_t>();
+}
+
+uint32_t ServerParameters::get_max_queued_messages() {
+    return var_map_["max-queued-messages"].as<uint32_t>();
+}
+
+SlowClientPolicy ServerParameters::get_slow_client_policy() {
+    return var_map_["slow-client-policy"].as<SlowClientPolicy>();
+}
+
 uint16_t ServerParameters::get_size_x() {
     return var_map_["size-x"].as<uint16_t>();
 }
@@ -176,6 +233,25 @@ bool Address::validate_port_number(string &number_str) {
     return true;
 }
 
+istream &operator>>(istream &in, SlowClientPolicy &policy) {
+    string token;
+    in >> token;
+
+    if (token == "disconnect") {
+        policy = SlowClientPolicy::DISCONNECT;
+    } else if (token == "snapshot") {
+        policy = SlowClientPolicy::SNAPSHOT;
+    } else {
+        throw invalid_argument(string("wrong slow client policy: ") + token);
+    }
+
+    return in;
+}
+
+ostream &operator<<(ostream &out, const SlowClientPolicy &policy) {
+    return out << (policy == SlowClientPolicy::DISCONNECT ? "disconnect" : "snapshot");
+}
+
 istream &operator>>(istream &in, Address &adr) {
     string token;
     in >> token;
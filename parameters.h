@@ -6,6 +6,15 @@
 
 struct Address;
 
+// What's done with client, which receives messages slower than they're sent
+enum class SlowClientPolicy {
+    DISCONNECT,
+    SNAPSHOT,
+};
+
+std::istream &operator>>(std::istream &in, SlowClientPolicy &policy);
+std::ostream &operator<<(std::ostream &out, const SlowClientPolicy &policy);
+
 class Parameters {
 public:
     // Result
@@ -31,6 +40,8 @@ public:
     Address get_gui_address();
     Address get_server_address();
     uint16_t get_port();
+    bool is_latest_draw_only();
+    bool is_fragmented_draws();
 
 private:
     void initialize_options_description() override;
@@ -50,6 +61,13 @@ public:
     std::string get_server_name();
     uint16_t get_port();
     uint32_t get_seed();
+    uint16_t get_rooms_count();
+    uint16_t get_threads_count();
+    uint16_t get_io_threads_count();
+    bool is_snapshot_catch_up();
+    uint64_t get_max_queued_bytes();
+    uint32_t get_max_queued_messages();
+    SlowClientPolicy get_slow_client_policy();
     uint16_t get_size_x();
     uint16_t get_size_y();
 
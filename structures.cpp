@@ -29,28 +29,23 @@ DrawMessage::Lobby::Lobby(GameBasicInfo &info, uint8_t playersCount,
     }
 }
 
-DrawMessage::Game::Game(GameBasicInfo &info, uint16_t turn, map<player_id_t, PlayerInfo> &players_info,
-                        map<bomb_id_t, Bomb> &bombs, unordered_set<Position, Position::Hash> &blocks,
-                        unordered_set<Position, Position::Hash> &explosions) : server_name(info.server_name_),
-                                                                               size_x(info.size_x_),
-                                                                               size_y(info.size_y_),
-                                                                               game_length(info.game_length_),
-                                                                               turn(turn),
-                                                                               players(),
-                                                                               player_positions(),
-                                                                               blocks(blocks.begin(), blocks.end()),
-                                                                               bombs_(),
-                                                                               explosions(explosions.begin(), explosions.end()),
-                                                                               scores() {
+DrawMessage::Game::Game(GameBasicInfo &info,
+                        const map<player_id_t, PlayerInfo> &players_info) : server_name(info.server_name_),
+                                                                            size_x(info.size_x_),
+                                                                            size_y(info.size_y_),
+                                                                            game_length(info.game_length_),
+                                                                            turn(0),
+                                                                            players(),
+                                                                            player_positions(),
+                                                                            blocks(),
+                                                                            bombs_(),
+                                                                            explosions(),
+                                                                            scores() {
     for (auto &it: players_info) {
         players.emplace(it.first, it.second.player);
         player_positions.emplace(it.first, it.second.position);
         scores.emplace(it.first, it.second.score);
     }
-
-    for (auto &it: bombs) {
-        bombs_.emplace_back(it.second);
-    }
 }
 
 bool Position::operator==(const Position &rhs) const {
@@ -3,10 +3,10 @@
 
 #include "parameters.h"
 #include <map>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <variant>
 #include <vector>
 
@@ -74,10 +74,11 @@ namespace Event {
         Position position;
     };
 
+    // vectors of events can be allocated in memory of one turn
     struct BombExplodedEvent {
         bomb_id_t id;
-        std::vector<player_id_t> robots_destroyed;
-        std::vector<Position> blocks_destroyed;
+        std::pmr::vector<player_id_t> robots_destroyed;
+        std::pmr::vector<Position> blocks_destroyed;
     };
 
     struct PlayerMovedEvent {
@@ -119,29 +120,30 @@ namespace DrawMessage {
     constexpr message_id_t GAME = 1;
 
     struct Lobby {
+        Lobby() = default;
         Lobby(GameBasicInfo &info, uint8_t playersCount, uint16_t explosionRadius,
               uint16_t bombTimer, std::map<player_id_t, PlayerInfo> &p);
 
         std::string server_name_;
-        uint8_t players_count_;
-        board_coord_t size_x_;
-        board_coord_t size_y;
-        uint16_t game_length;
-        uint16_t explosion_radius;
-        uint16_t bomb_timer;
+        uint8_t players_count_{};
+        board_coord_t size_x_{};
+        board_coord_t size_y{};
+        uint16_t game_length{};
+        uint16_t explosion_radius{};
+        uint16_t bomb_timer{};
         std::unordered_map<player_id_t, Player> players;
     };
 
     struct Game {
-        Game(GameBasicInfo &info, uint16_t turn, std::map<player_id_t, PlayerInfo> &players_info,
-             std::map<bomb_id_t, Bomb> &bombs, std::unordered_set<Position, Position::Hash> &blocks,
-             std::unordered_set<Position, Position::Hash> &explosions);
+        Game() = default;
+        // Game in turn 0 without blocks, bombs and explosions
+        Game(GameBasicInfo &info, const std::map<player_id_t, PlayerInfo> &players_info);
 
         std::string server_name;
-        board_coord_t size_x;
-        board_coord_t size_y;
-        uint16_t game_length;
-        uint16_t turn;
+        board_coord_t size_x{};
+        board_coord_t size_y{};
+        uint16_t game_length{};
+        uint16_t turn{};
         std::unordered_map<player_id_t, Player> players;
         std::unordered_map<player_id_t, Position> player_positions;
         std::vector<Position> blocks;
@@ -151,7 +153,23 @@ namespace DrawMessage {
     };
 
     using draw_message = std::variant<Lobby, Game>;
-    using draw_message_optional = std::optional<draw_message>;
+
+    // Header of one datagram of a draw sent in fragments, payloads of
+    // fragments from 0 to count - 1 of a frame make an encoded draw message
+    struct Fragment {
+        // encoded frame, index and count
+        static constexpr size_t HEADER_LENGTH = 8;
+        // every fragment, except the last one, has exactly this payload,
+        // so header and payload fit in one udp datagram of 65507 bytes
+        static constexpr size_t MAX_PAYLOAD = 65507 - HEADER_LENGTH;
+        // receiver keeps memory for count * MAX_PAYLOAD bytes, so bigger frames
+        // are dropped, it's a whole number of payloads of about 16 MiB
+        static constexpr size_t MAX_FRAME_SIZE = 256 * MAX_PAYLOAD;
+
+        uint32_t frame;
+        uint16_t index;
+        uint16_t count;
+    };
 }
 
 namespace ServerMessage {
@@ -182,6 +200,7 @@ namespace ServerMessage {
     };
 
     struct GameStarted {
+        GameStarted() = default;
         explicit GameStarted(const std::map<player_id_t, PlayerInfo> &players_info);
         explicit GameStarted(const std::unordered_map<player_id_t, Player> &players);
 
@@ -190,10 +209,11 @@ namespace ServerMessage {
 
     struct Turn {
         uint16_t turn;
-        std::vector<Event::event_message> events;
+        std::pmr::vector<Event::event_message> events;
     };
 
     struct GameEnded {
+        GameEnded() = default;
         explicit GameEnded(const std::unordered_map<player_id_t, score_t> &scores);
         explicit GameEnded(const std::map<player_id_t, PlayerInfo> &players_info);
 
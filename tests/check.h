@@ -0,0 +1,18 @@
+#ifndef ROBOTS_CHECK_H
+#define ROBOTS_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+
+// Ends the test with failure, when condition doesn't hold,
+// it works also when assert is turned off by NDEBUG
+#define CHECK(condition) check((condition), #condition, __FILE__, __LINE__)
+
+inline void check(bool condition, const char *text, const char *file, int line) {
+    if (!condition) {
+        std::cerr << file << ":" << line << ": check failed: " << text << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+#endif //ROBOTS_CHECK_H
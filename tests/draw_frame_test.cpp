@@ -0,0 +1,174 @@
+// Test of draws sent to gui in fragments. Fragments of a draw bigger than
+// a datagram can come in any order, be repeated or lost, and the receiver
+// has to put together only the newest frame, also when frame numbers wrap.
+
+#include "check.h"
+#include "../buffers/draw_frame_buffer.h"
+#include "../buffers/outgoing_buffer.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+    constexpr uint16_t SIZE = 400;
+
+    // Game with enough blocks to need a few datagrams
+    DrawMessage::Game get_big_game(uint16_t turn) {
+        DrawMessage::Game game;
+        game.server_name = "draw frame test";
+        game.size_x = SIZE;
+        game.size_y = SIZE;
+        game.game_length = 1000;
+        game.turn = turn;
+        game.players.emplace(0, Player{"player", "address"});
+        game.player_positions.emplace(0, Position{1, 2});
+        game.scores.emplace(0, 3);
+
+        for (uint16_t x = 0; x < SIZE; x++) {
+            for (uint16_t y = 0; y < SIZE; y += 2) {
+                game.blocks.push_back(Position{x, y});
+            }
+        }
+        game.bombs_.push_back(Bomb{Position{4, 5}, 6});
+        game.explosions.push_back(Position{7, 8});
+
+        return game;
+    }
+
+    vector<uint8_t> encode(const DrawMessage::draw_message &msg) {
+        OutgoingBuffer encoded(msg);
+        return {encoded.get_buffer(), encoded.get_buffer() + encoded.size()};
+    }
+
+    void receive(DrawFrameBuffer &buffer, const shared_outgoing_buffer &fragment) {
+        vector<uint8_t> datagram(fragment->get_buffer(), fragment->get_buffer() + fragment->size());
+        datagram.resize(Buffer::MAX_PACKET_LENGTH);
+        buffer.add_packet(datagram, fragment->size());
+    }
+
+    // Reads the frame and checks it's the encoded draw
+    void check_read(DrawFrameBuffer &buffer, const DrawMessage::draw_message &expected) {
+        DrawMessage::draw_message result;
+        CHECK(buffer.try_read_draw_message(result) == ReadStatus::COMPLETE);
+        CHECK(encode(result) == encode(expected));
+        CHECK(buffer.try_read_draw_message(result) == ReadStatus::NEED_MORE);
+    }
+
+    vector<shared_outgoing_buffer> get_fragments(const DrawMessage::draw_message &msg, uint32_t frame) {
+        OutgoingBuffer encoded(msg);
+        vector<shared_outgoing_buffer> fragments = split_into_fragments(encoded, frame);
+
+        for (auto &fragment: fragments) {
+            CHECK(fragment->size() <= Buffer::MAX_PACKET_LENGTH);
+        }
+        return fragments;
+    }
+
+    void test_shuffled_fragments() {
+        DrawMessage::draw_message msg{get_big_game(1)};
+        vector<shared_outgoing_buffer> fragments = get_fragments(msg, 0);
+        CHECK(fragments.size() > 2);
+
+        minstd_rand random_engine(1);
+        shuffle(fragments.begin(), fragments.end(), random_engine);
+
+        DrawFrameBuffer buffer;
+        DrawMessage::draw_message result;
+        for (auto &fragment: fragments) {
+            CHECK(buffer.try_read_draw_message(result) == ReadStatus::NEED_MORE);
+            receive(buffer, fragment);
+            // repeated fragment doesn't change anything
+            receive(buffer, fragment);
+        }
+
+        check_read(buffer, msg);
+        CHECK(buffer.get_dropped_frames() == 0);
+    }
+
+    void test_newer_frames() {
+        DrawMessage::draw_message old_msg{get_big_game(1)};
+        DrawMessage::draw_message new_msg{get_big_game(2)};
+        uint32_t old_frame = numeric_limits<uint32_t>::max();
+        vector<shared_outgoing_buffer> old_fragments = get_fragments(old_msg, old_frame);
+        // frame numbers wrap around, so frame 0 is newer
+        vector<shared_outgoing_buffer> new_fragments = get_fragments(new_msg, old_frame + 1);
+
+        DrawFrameBuffer buffer;
+        receive(buffer, old_fragments[0]);
+        for (auto &fragment: new_fragments) {
+            receive(buffer, fragment);
+        }
+        // the older frame can't be finished anymore
+        for (auto &fragment: old_fragments) {
+            receive(buffer, fragment);
+        }
+
+        check_read(buffer, new_msg);
+        CHECK(buffer.get_frame() == 0);
+        CHECK(buffer.get_dropped_frames() == 1);
+    }
+
+    void test_lost_fragment() {
+        DrawMessage::draw_message msg{get_big_game(1)};
+        vector<shared_outgoing_buffer> fragments = get_fragments(msg, 5);
+
+        DrawFrameBuffer buffer;
+        DrawMessage::draw_message result;
+        for (size_t i = 1; i < fragments.size(); i++) {
+            receive(buffer, fragments[i]);
+        }
+        CHECK(buffer.try_read_draw_message(result) == ReadStatus::NEED_MORE);
+
+        receive(buffer, fragments[0]);
+        check_read(buffer, msg);
+    }
+
+    void test_small_draw() {
+        DrawMessage::Game game = get_big_game(1);
+        game.blocks.clear();
+        DrawMessage::draw_message msg{move(game)};
+        vector<shared_outgoing_buffer> fragments = get_fragments(msg, 7);
+        CHECK(fragments.size() == 1);
+
+        DrawFrameBuffer buffer;
+        receive(buffer, fragments[0]);
+        check_read(buffer, msg);
+    }
+
+    // Count of a forged fragment would need about 4 GiB for the frame, it's
+    // ignored and doesn't stop frames sent later
+    void test_too_big_frame() {
+        vector<uint8_t> payload(10);
+        DrawMessage::Fragment forged_header{9, 65534, 65535};
+        CHECK(forged_header.count * DrawMessage::Fragment::MAX_PAYLOAD > DrawMessage::Fragment::MAX_FRAME_SIZE);
+        auto forged = make_shared<const OutgoingBuffer>(forged_header, payload.data(), payload.size());
+
+        DrawMessage::draw_message msg{get_big_game(1)};
+        vector<shared_outgoing_buffer> fragments = get_fragments(msg, 1);
+
+        DrawFrameBuffer buffer;
+        receive(buffer, forged);
+        CHECK(buffer.get_frame() == 0);
+        for (auto &fragment: fragments) {
+            receive(buffer, fragment);
+        }
+
+        check_read(buffer, msg);
+        CHECK(buffer.get_frame() == 1);
+        CHECK(buffer.get_dropped_frames() == 0);
+    }
+}
+
+int main() {
+    test_shuffled_fragments();
+    test_newer_frames();
+    test_lost_fragment();
+    test_small_draw();
+    test_too_big_frame();
+
+    return 0;
+}
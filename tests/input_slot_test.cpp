@@ -0,0 +1,103 @@
+// Stress test of InputSlot: thread reading connection publishes inputs and
+// thread playing the room takes them at the same time. Taken inputs can't
+// be torn or older than the ones taken before, and the latest input can't
+// be lost.
+
+#include "check.h"
+#include "../connections/input_slot.h"
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+namespace {
+    constexpr size_t MESSAGES_NO = 1000000;
+
+    ClientMessage::client_message get_message(size_t i) {
+        switch (i % 5) {
+            case 4:
+                return ClientMessage::PlaceBomb{};
+            default:
+                return ClientMessage::Move{static_cast<Direction>(i % 5)};
+        }
+    }
+
+    bool is_same(const ClientMessage::client_message &a, const ClientMessage::client_message &b) {
+        if (a.index() != b.index()) {
+            return false;
+        }
+        return a.index() != ClientMessage::MOVE
+               || get<ClientMessage::Move>(a).direction == get<ClientMessage::Move>(b).direction;
+    }
+
+    // Every input is taken before the next one is published, so none can be replaced
+    void test_handoff() {
+        InputSlot slot;
+        atomic<size_t> taken{0};
+
+        thread publisher([&slot, &taken]() {
+            for (size_t i = 0; i < MESSAGES_NO; i++) {
+                slot.publish(get_message(i));
+                while (taken.load(memory_order_acquire) <= i) {
+                    this_thread::yield();
+                }
+            }
+        });
+
+        for (size_t i = 0; i < MESSAGES_NO; i++) {
+            ClientMessage::client_message_optional msg;
+            while (!(msg = slot.take()).has_value()) {
+                this_thread::yield();
+            }
+
+            CHECK(is_same(msg.value(), get_message(i)));
+            taken.store(i + 1, memory_order_release);
+        }
+
+        publisher.join();
+        CHECK(!slot.take().has_value());
+    }
+
+    // Inputs are published without waiting, so they can replace each other,
+    // but the last one, which is the only PlaceBlock, has to be taken once
+    // and nothing can be taken after it
+    void test_overwriting() {
+        InputSlot slot;
+        atomic<bool> is_published{false};
+
+        thread publisher([&slot, &is_published]() {
+            for (size_t i = 0; i < MESSAGES_NO; i++) {
+                slot.publish(get_message(i));
+            }
+            slot.publish(ClientMessage::PlaceBlock{});
+            is_published.store(true, memory_order_release);
+        });
+
+        size_t taken = 0;
+        bool is_last_taken = false;
+        while (!is_last_taken) {
+            bool was_published = is_published.load(memory_order_acquire);
+            ClientMessage::client_message_optional msg = slot.take();
+
+            if (msg.has_value()) {
+                taken++;
+                is_last_taken = msg.value().index() == ClientMessage::PLACE_BLOCK;
+            } else {
+                // after publishing ends, the last input waits in the slot
+                CHECK(!was_published);
+                this_thread::yield();
+            }
+        }
+
+        publisher.join();
+        CHECK(taken <= MESSAGES_NO + 1);
+        CHECK(!slot.take().has_value());
+    }
+}
+
+int main() {
+    test_handoff();
+    test_overwriting();
+
+    return 0;
+}
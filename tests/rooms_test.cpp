@@ -0,0 +1,491 @@
+// Test of turns computed by rooms while the previous ones are still encoded
+// and sent by other threads. Memory of a turn has to stay untouched until
+// its message is encoded, so every connection of a room receives the same
+// correct messages. Snapshot of game has to bring a new client to the same
+// state as all turns.
+
+#include "check.h"
+#include "../buffers/outgoing_buffer.h"
+#include "../buffers/tcp_incoming_buffer.h"
+#include "../connections/server_connections.h"
+#include "../game_managers/client_game_info.h"
+#include "../game_managers/server_game_info.h"
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+using tcp = boost::asio::ip::tcp;
+using namespace std;
+
+namespace {
+    constexpr uint16_t SIZE = 20;
+    constexpr uint16_t GAME_LENGTH = 100;
+    constexpr player_id_t PLAYERS_COUNT = 2;
+    constexpr size_t ROOMS_COUNT = 3;
+
+    ServerParameters get_parameters(uint16_t port, const vector<string> &extra_args = {}) {
+        vector<string> args = {"robots-server", "-b", "3", "-c", to_string(PLAYERS_COUNT), "-d", "5", "-e", "4",
+                               "-k", "40", "-l", to_string(GAME_LENGTH), "-n", "rooms test", "-p", to_string(port),
+                               "-x", to_string(SIZE), "-y", to_string(SIZE), "-s", "7",
+                               "-r", to_string(ROOMS_COUNT), "-t", to_string(ROOMS_COUNT), "-i", "2"};
+        args.insert(args.end(), extra_args.begin(), extra_args.end());
+        vector<char *> argv;
+        for (auto &arg: args) {
+            argv.push_back(arg.data());
+        }
+
+        ServerParameters result;
+        CHECK(result.read_program_arguments(static_cast<int>(argv.size()), argv.data()));
+        return result;
+    }
+
+    bool is_on_board(const Position &position) {
+        return position.x < SIZE && position.y < SIZE;
+    }
+
+    void check_events(const ServerMessage::Turn &turn) {
+        for (auto &event: turn.events) {
+            switch (event.index()) {
+                case Event::BOMB_PLACED :
+                    CHECK(is_on_board(get<Event::BombPlacedEvent>(event).position));
+                    break;
+                case Event::BOMB_EXPLODED : {
+                    auto &explosion = get<Event::BombExplodedEvent>(event);
+                    for (auto id: explosion.robots_destroyed) {
+                        CHECK(id < PLAYERS_COUNT);
+                    }
+                    for (auto &block: explosion.blocks_destroyed) {
+                        CHECK(is_on_board(block));
+                    }
+                    break;
+                }
+                case Event::PLAYER_MOVED :
+                    CHECK(get<Event::PlayerMovedEvent>(event).id < PLAYERS_COUNT);
+                    CHECK(is_on_board(get<Event::PlayerMovedEvent>(event).position));
+                    break;
+                default:
+                    CHECK(is_on_board(get<Event::BlockPlacedEvent>(event).position));
+            }
+        }
+    }
+
+    ClientMessage::client_message get_random_action(minstd_rand &random_engine) {
+        switch (random_engine() % 3) {
+            case 0:
+                return ClientMessage::PlaceBomb{};
+            case 1:
+                return ClientMessage::PlaceBlock{};
+            default:
+                return ClientMessage::Move{static_cast<Direction>(random_engine() % 4)};
+        }
+    }
+
+    vector<uint8_t> encode(const ServerMessage::server_message &msg) {
+        OutgoingBuffer encoded(msg);
+        return {encoded.get_buffer(), encoded.get_buffer() + encoded.size()};
+    }
+
+    // Every turn is encoded again by other thread while the next one is computed,
+    // like on broadcast strand, bytes can't differ from encoding made at once
+    void test_turn_memory() {
+        ServerParameters parameters = get_parameters(0);
+        ServerGameInfo game(parameters, 7);
+        minstd_rand random_engine(1);
+
+        for (player_id_t id = 0; id < PLAYERS_COUNT; id++) {
+            ClientMessage::Join join{"player " + to_string(id)};
+            CHECK(game.handle_client_join_message(join, "address " + to_string(id)).has_value());
+        }
+        game.start_game();
+
+        thread encoder;
+        while (!game.is_end_of_game()) {
+            unordered_map<player_id_t, ClientMessage::client_message> msgs;
+            for (player_id_t id = 0; id < PLAYERS_COUNT; id++) {
+                msgs.emplace(id, get_random_action(random_engine));
+            }
+
+            auto [turn, arena] = game.handle_turn(msgs);
+
+            CHECK(turn.events.get_allocator().resource() == arena->get_resource());
+            for (auto &event: turn.events) {
+                if (event.index() == Event::BOMB_EXPLODED) {
+                    auto &explosion = get<Event::BombExplodedEvent>(event);
+                    CHECK(explosion.robots_destroyed.get_allocator().resource() == arena->get_resource());
+                    CHECK(explosion.blocks_destroyed.get_allocator().resource() == arena->get_resource());
+                }
+            }
+            check_events(turn);
+
+            ServerMessage::server_message msg{move(turn)};
+            vector<uint8_t> expected = encode(msg);
+
+            if (encoder.joinable()) {
+                encoder.join();
+            }
+            encoder = thread([arena = move(arena), msg = move(msg), expected = move(expected)]() {
+                CHECK(encode(msg) == expected);
+            });
+        }
+
+        encoder.join();
+    }
+
+    vector<tuple<board_coord_t, board_coord_t, uint16_t>> sorted(const vector<Position> &positions) {
+        vector<tuple<board_coord_t, board_coord_t, uint16_t>> result;
+        for (auto &position: positions) {
+            result.emplace_back(position.x, position.y, 0);
+        }
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    vector<tuple<board_coord_t, board_coord_t, uint16_t>> sorted(const vector<Bomb> &bombs) {
+        vector<tuple<board_coord_t, board_coord_t, uint16_t>> result;
+        for (auto &bomb: bombs) {
+            result.emplace_back(bomb.position.x, bomb.position.y, bomb.timer);
+        }
+        sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Bombs of the game by their ids, with explosion turns instead of timers
+    using placed_bombs = unordered_map<bomb_id_t, Bomb>;
+
+    void update_bombs(const ServerMessage::Turn &turn, uint16_t bomb_timer, placed_bombs &bombs) {
+        for (auto &event: turn.events) {
+            if (event.index() == Event::BOMB_PLACED) {
+                auto &placed = get<Event::BombPlacedEvent>(event);
+                bombs[placed.id] = Bomb{placed.position, static_cast<uint16_t>(turn.turn + bomb_timer)};
+            } else if (event.index() == Event::BOMB_EXPLODED) {
+                bombs.erase(get<Event::BombExplodedEvent>(event).id);
+            }
+        }
+    }
+
+    vector<Bomb> get_timers(const placed_bombs &bombs, uint16_t turn) {
+        vector<Bomb> result;
+        for (auto &[id, bomb]: bombs) {
+            result.push_back(Bomb{bomb.position, static_cast<uint16_t>(bomb.timer - turn)});
+        }
+        return result;
+    }
+
+    void check_same_game(const DrawMessage::Game &expected, const DrawMessage::Game &actual) {
+        CHECK(actual.turn == expected.turn);
+        CHECK(actual.player_positions == expected.player_positions);
+        CHECK(actual.scores == expected.scores);
+        CHECK(sorted(actual.blocks) == sorted(expected.blocks));
+        CHECK(sorted(actual.explosions) == sorted(expected.explosions));
+        CHECK(sorted(actual.bombs_) == sorted(expected.bombs_));
+    }
+
+    // Client catching up from snapshot made after any turn draws the same
+    // game as client, which got all turns
+    void test_snapshot() {
+        ServerParameters parameters = get_parameters(0, {"-S"});
+        ServerGameInfo game(parameters, 11);
+        minstd_rand random_engine(2);
+        ClientGameInfo watcher("watcher");
+        score_t max_score = 0;
+        placed_bombs bombs;
+
+        auto hello = [&parameters]() {
+            return ServerMessage::server_message{ServerMessage::Hello(parameters)};
+        };
+        auto watch = [&watcher](ServerMessage::server_message &&msg) {
+            return watcher.handle_server_message(msg);
+        };
+
+        watch(hello());
+        for (player_id_t id = 0; id < PLAYERS_COUNT; id++) {
+            ClientMessage::Join join{"player " + to_string(id)};
+            auto accepted = game.handle_client_join_message(join, "address " + to_string(id));
+            CHECK(accepted.has_value());
+            watch(move(*accepted));
+        }
+        auto [started, first_turn] = game.start_game();
+        watch(move(started));
+        watch(move(first_turn.turn));
+
+        while (!game.is_end_of_game()) {
+            unordered_map<player_id_t, ClientMessage::client_message> msgs;
+            for (player_id_t id = 0; id < PLAYERS_COUNT; id++) {
+                msgs.emplace(id, get_random_action(random_engine));
+            }
+
+            auto [turn, arena] = game.handle_turn(msgs);
+            update_bombs(turn, parameters.get_bomb_timer(), bombs);
+            uint16_t turn_no = turn.turn;
+            DrawState *expected = watch(move(turn));
+            CHECK(expected != nullptr && expected->get_message().index() == DrawMessage::GAME);
+            // timers are computed only when the draw is taken
+            CHECK(sorted(get<DrawMessage::Game>(expected->get_message()).bombs_) == sorted(get_timers(bombs, turn_no)));
+
+            ClientGameInfo late("late");
+            ServerMessage::server_message late_hello = hello();
+            late.handle_server_message(late_hello);
+            DrawState *actual = nullptr;
+            for (auto &msg: game.get_catch_up_messages()) {
+                actual = late.handle_server_message(msg);
+            }
+            CHECK(actual != nullptr && actual->get_message().index() == DrawMessage::GAME);
+
+            auto &expected_game = get<DrawMessage::Game>(expected->get_message());
+            check_same_game(expected_game, get<DrawMessage::Game>(actual->get_message()));
+            for (auto &[id, score]: expected_game.scores) {
+                max_score = max(max_score, score);
+            }
+        }
+
+        // scores have to be replayed too
+        CHECK(max_score > 1);
+    }
+
+    // Plays until the end of game and saves all bytes received from server
+    void play(uint16_t port, size_t id, vector<uint8_t> &received) {
+        boost::asio::io_context io_context;
+        tcp::socket socket(io_context);
+        socket.connect(tcp::endpoint(boost::asio::ip::address_v6::loopback(), port));
+
+        minstd_rand random_engine(static_cast<uint32_t>(id));
+        auto send = [&socket](const ClientMessage::client_message &msg) {
+            OutgoingBuffer encoded(msg);
+            boost::asio::write(socket, boost::asio::buffer(encoded.get_buffer(), encoded.size()));
+        };
+        send(ClientMessage::Join{"player " + to_string(id)});
+
+        TcpIncomingBuffer buffer;
+        ServerMessage::server_message msg;
+        uint16_t next_turn = 0;
+        bool is_game_ended = false;
+
+        while (!is_game_ended) {
+            span<uint8_t> free_space = buffer.get_free_space();
+            size_t length = socket.read_some(boost::asio::buffer(free_space.data(), free_space.size()));
+            received.insert(received.end(), free_space.data(), free_space.data() + length);
+            buffer.commit_packet(length);
+
+            ReadStatus status;
+            while ((status = buffer.try_read_server_message(msg)) == ReadStatus::COMPLETE) {
+                if (msg.index() == ServerMessage::TURN) {
+                    auto &turn = get<ServerMessage::Turn>(msg);
+                    CHECK(turn.turn == next_turn++);
+                    check_events(turn);
+                    send(get_random_action(random_engine));
+                } else if (msg.index() == ServerMessage::GAME_ENDED) {
+                    is_game_ended = true;
+                }
+            }
+            CHECK(status != ReadStatus::MALFORMED);
+        }
+
+        CHECK(next_turn == GAME_LENGTH + 1);
+    }
+
+    // Reads messages as a client, which doesn't join, until the end of game
+    void watch(uint16_t port, uint16_t &next_turn) {
+        boost::asio::io_context io_context;
+        tcp::socket socket(io_context);
+        socket.connect(tcp::endpoint(boost::asio::ip::address_v6::loopback(), port));
+
+        TcpIncomingBuffer buffer;
+        ServerMessage::server_message msg;
+        bool is_game_ended = false;
+
+        while (!is_game_ended) {
+            span<uint8_t> free_space = buffer.get_free_space();
+            boost::system::error_code ec;
+            size_t length = socket.read_some(boost::asio::buffer(free_space.data(), free_space.size()), ec);
+            // server can't close connection of a client, which is catching up
+            CHECK(!ec);
+            buffer.commit_packet(length);
+
+            ReadStatus status;
+            while ((status = buffer.try_read_server_message(msg)) == ReadStatus::COMPLETE) {
+                if (msg.index() == ServerMessage::TURN) {
+                    CHECK(get<ServerMessage::Turn>(msg).turn == next_turn++);
+                } else if (msg.index() == ServerMessage::GAME_ENDED) {
+                    is_game_ended = true;
+                }
+            }
+            CHECK(status != ReadStatus::MALFORMED);
+        }
+    }
+
+    // Room checking, that every turn is broadcast together with memory of its events
+    class CheckedRoom : public Room {
+    public:
+        using Room::Room;
+
+        size_t get_checked_turns() const {
+            return checked_turns_;
+        }
+
+        // Client is added right before the given turn is broadcast
+        void add_late_client(tcp::socket &&socket, uint16_t turn) {
+            late_socket_.emplace(move(socket));
+            late_turn_ = turn;
+        }
+
+    protected:
+        void broadcast(PendingMessage &&pending, bool is_saved) override {
+            if (pending.msg.index() == ServerMessage::TURN) {
+                auto &turn = get<ServerMessage::Turn>(pending.msg);
+                CHECK(pending.arena != nullptr);
+                CHECK(turn.events.get_allocator().resource() == pending.arena->get_resource());
+                checked_turns_++;
+
+                if (late_socket_.has_value() && turn.turn == late_turn_) {
+                    add_client(move(*late_socket_), false);
+                    late_socket_.reset();
+                }
+            }
+
+            Room::broadcast(move(pending), is_saved);
+        }
+
+    private:
+        size_t checked_turns_ = 0;
+        optional<tcp::socket> late_socket_;
+        uint16_t late_turn_ = 0;
+    };
+
+    // Turns computed by the room are sent with their arenas, so the arena
+    // can't be reused while the turn is encoded
+    void test_room_turns() {
+        auto port = static_cast<uint16_t>(40000 + getpid() % 20000);
+        ServerParameters parameters = get_parameters(port);
+        boost::asio::io_context io_context;
+        boost::asio::io_context connections_context;
+        // joins come later, so contexts can't stop for lack of work
+        auto work_guard = boost::asio::make_work_guard(io_context);
+        auto connections_work_guard = boost::asio::make_work_guard(connections_context);
+        WorkerPool workers(1);
+        CheckedRoom room(io_context, connections_context, workers, parameters, 0);
+        tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v6(), port));
+
+        vector<vector<uint8_t>> received(PLAYERS_COUNT);
+        vector<thread> players;
+        for (size_t id = 0; id < received.size(); id++) {
+            players.emplace_back(play, port, id, ref(received[id]));
+        }
+        for (size_t id = 0; id < received.size(); id++) {
+            room.add_client(acceptor.accept(boost::asio::make_strand(connections_context)), false);
+        }
+
+        thread room_thread([&io_context]() {
+            io_context.run();
+        });
+        thread connections_thread([&connections_context]() {
+            connections_context.run();
+        });
+        for (auto &player: players) {
+            player.join();
+        }
+
+        io_context.stop();
+        connections_context.stop();
+        room_thread.join();
+        connections_thread.join();
+
+        CHECK(room.get_checked_turns() == GAME_LENGTH + 1);
+        CHECK(received[0] == received[1]);
+    }
+
+    // Catch-up of a late client is bigger than the limit of queued bytes, but only
+    // messages queued after it are limited, so the client isn't disconnected
+    void test_late_catch_up() {
+        auto port = static_cast<uint16_t>(40001 + getpid() % 20000);
+        constexpr uint16_t LATE_TURN = GAME_LENGTH - 5;
+        ServerParameters parameters = get_parameters(port, {"--max-queued-bytes", "1024"});
+        boost::asio::io_context io_context;
+        boost::asio::io_context connections_context;
+        // late client isn't handled until the game ends, so all of its messages wait in the queue
+        boost::asio::io_context late_context;
+        auto work_guard = boost::asio::make_work_guard(io_context);
+        auto connections_work_guard = boost::asio::make_work_guard(connections_context);
+        WorkerPool workers(1);
+        CheckedRoom room(io_context, connections_context, workers, parameters, 0);
+        tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v6(), port));
+
+        vector<vector<uint8_t>> received(PLAYERS_COUNT);
+        vector<thread> players;
+        for (size_t id = 0; id < received.size(); id++) {
+            players.emplace_back(play, port, id, ref(received[id]));
+        }
+        for (size_t id = 0; id < received.size(); id++) {
+            room.add_client(acceptor.accept(boost::asio::make_strand(connections_context)), false);
+        }
+        uint16_t late_turns = 0;
+        thread watcher(watch, port, ref(late_turns));
+        room.add_late_client(acceptor.accept(boost::asio::make_strand(late_context)), LATE_TURN);
+
+        thread room_thread([&io_context]() {
+            io_context.run();
+        });
+        thread connections_thread([&connections_context]() {
+            connections_context.run();
+        });
+        for (auto &player: players) {
+            player.join();
+        }
+        thread late_thread([&late_context]() {
+            late_context.run();
+        });
+        watcher.join();
+
+        io_context.stop();
+        connections_context.stop();
+        late_context.stop();
+        room_thread.join();
+        connections_thread.join();
+        late_thread.join();
+
+        CHECK(late_turns == GAME_LENGTH + 1);
+    }
+
+    // Players of every room get the same bytes, rooms differ by their players
+    void test_rooms() {
+        auto port = static_cast<uint16_t>(20000 + getpid() % 20000);
+        ServerParameters parameters = get_parameters(port);
+        boost::asio::io_context io_context;
+        Server server(io_context, parameters);
+        thread room_thread([&io_context]() {
+            io_context.run();
+        });
+
+        vector<vector<uint8_t>> received(ROOMS_COUNT * PLAYERS_COUNT);
+        vector<thread> players;
+        for (size_t id = 0; id < received.size(); id++) {
+            players.emplace_back(play, port, id, ref(received[id]));
+        }
+        for (auto &player: players) {
+            player.join();
+        }
+
+        io_context.stop();
+        room_thread.join();
+
+        // every stream is the same only as streams of the other players of its room
+        for (auto &stream: received) {
+            CHECK(count(received.begin(), received.end(), stream) == PLAYERS_COUNT);
+        }
+    }
+}
+
+int main() {
+    test_turn_memory();
+    test_snapshot();
+    test_room_turns();
+    test_late_catch_up();
+    test_rooms();
+
+    return 0;
+}
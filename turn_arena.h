@@ -0,0 +1,38 @@
+#ifndef ROBOTS_TURN_ARENA_H
+#define ROBOTS_TURN_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Monotonic memory for objects living only during one turn (or one message),
+// everything is released at once and the first block is used again
+class TurnArena {
+public:
+    static constexpr size_t INITIAL_SIZE = 1 << 16;
+
+    explicit TurnArena(size_t initial_size = INITIAL_SIZE) : initial_block_(initial_size),
+                                                            resource_(initial_block_.data(), initial_block_.size()) {}
+
+    TurnArena(const TurnArena &) = delete;
+    TurnArena &operator=(const TurnArena &) = delete;
+
+    std::pmr::memory_resource *get_resource() {
+        return &resource_;
+    }
+
+    // all objects allocated in arena have to be destroyed before
+    void release() {
+        resource_.release();
+    }
+
+private:
+    std::vector<std::byte> initial_block_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+// Shared by objects allocated in arena, which are used by other threads
+using shared_turn_arena = std::shared_ptr<TurnArena>;
+
+#endif //ROBOTS_TURN_ARENA_H